@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include "assembler.hpp"
+#include "assembly_error.hpp"
+#include "parser.hpp"
+#include "code.hpp"
+#include "peephole.hpp"
+#include "symbol_table.hpp"
+
+namespace {
+
+const std::size_t romSize = 32768;
+const unsigned int screenAddress = 0x4000;
+
+// Chunks smaller than this are not worth a thread of their own
+const std::size_t minChunkSize = 256 * 1024;
+
+// A run of whole lines and the words encoded from it. Label and symbol
+// positions are relative to the start of the chunk.
+struct Chunk {
+    char* begin;
+    char* end;
+    std::vector<Instruction> instructions;
+    std::vector<uint16_t> words;
+    std::vector<std::pair<std::size_t, std::string_view>> labels;
+    std::vector<std::pair<std::size_t, std::string_view>> symbols;
+    std::exception_ptr error;
+};
+
+void parseChunk(Chunk& chunk)
+{
+    Parser parser{chunk.begin, chunk.end};
+
+    while (parser.hasMoreCommands()) {
+        parser.advance();
+        chunk.instructions.push_back(parser.parse());
+    }
+}
+
+void encodeChunk(Chunk& chunk)
+{
+    for (const auto& instruction : chunk.instructions) {
+        if (instruction.type == L_COMMAND) {
+            chunk.labels.emplace_back(chunk.words.size(), instruction.symbol);
+            continue;
+        }
+
+        auto code = Code{instruction};
+        if (!code.isResolved()) {
+            chunk.symbols.emplace_back(chunk.words.size(), instruction.symbol);
+        }
+        chunk.words.push_back(code.word());
+    }
+}
+
+// Runs step over every chunk on its own thread, then rethrows the first
+// error in program order
+void forEachChunk(std::vector<Chunk>& chunks, void (*step)(Chunk&))
+{
+    auto run = [step](Chunk& chunk) {
+        try {
+            step(chunk);
+        } catch (...) {
+            chunk.error = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers{};
+    for (std::size_t i = 1; i < chunks.size(); i++) {
+        workers.emplace_back(run, std::ref(chunks[i]));
+    }
+    run(chunks[0]);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (const auto& chunk : chunks) {
+        if (chunk.error) {
+            std::rethrow_exception(chunk.error);
+        }
+    }
+}
+
+// Splits [begin, end) into at most jobs chunks, each ending after a newline
+std::vector<Chunk> splitLines(char* begin, char* end, unsigned int jobs)
+{
+    auto size = static_cast<std::size_t>(end - begin);
+    auto count = std::max<std::size_t>(1, std::min<std::size_t>(jobs, size / minChunkSize));
+
+    std::vector<Chunk> chunks{};
+    for (std::size_t i = 1; begin != end; i++) {
+        auto chunkEnd = i < count ? std::find(std::min(begin + size / count, end), end, '\n') : end;
+        if (chunkEnd != end) {
+            chunkEnd++;
+        }
+        chunks.push_back(Chunk{ begin, chunkEnd });
+        begin = chunkEnd;
+    }
+    return chunks;
+}
+
+// Gathers every chunk's instructions into the first chunk
+void mergeChunks(std::vector<Chunk>& chunks)
+{
+    auto& all = chunks.front().instructions;
+    for (std::size_t i = 1; i < chunks.size(); i++) {
+        all.insert(all.end(), chunks[i].instructions.begin(), chunks[i].instructions.end());
+    }
+    chunks.resize(1);
+}
+
+}
+
+// Parsing and encoding happen per chunk, leaving symbolic A-instructions
+// as placeholders. Resolving them afterwards in program order means
+// labels may be used before they are defined, and variables are still
+// numbered by first use.
+std::vector<uint16_t> assemble(std::string_view source, const AssemblyOptions& options, AssemblyInfo* info)
+{
+    // The parser sanitises lines in place, so it needs its own copy
+    std::string buffer{source};
+    if (buffer.empty()) {
+        return {};
+    }
+
+    auto chunks = splitLines(buffer.data(), buffer.data() + buffer.size(), options.jobs);
+    forEachChunk(chunks, parseChunk);
+
+    if (options.optimise) {
+        // Patterns may span chunk boundaries, so the optimiser sees the
+        // whole program at once
+        mergeChunks(chunks);
+        auto saved = optimise(chunks.front().instructions);
+        if (info != nullptr) {
+            info->wordsSaved = saved;
+        }
+    }
+
+    forEachChunk(chunks, encodeChunk);
+
+    SymbolTable table{};
+    std::size_t wordCount = 0;
+    for (const auto& chunk : chunks) {
+        for (const auto& [index, name] : chunk.labels) {
+            table.addEntry(name, wordCount + index);
+            if (info != nullptr) {
+                info->labels.emplace_back(name, wordCount + index);
+            }
+        }
+        wordCount += chunk.words.size();
+    }
+
+    // Every label is known now, so anything undefined is a variable.
+    // Symbols are resolved before any size check so that a program which
+    // overflows still reports the variables it would need.
+    std::size_t variableCount = 0;
+    std::string variableError;
+    for (auto& chunk : chunks) {
+        for (const auto& [index, name] : chunk.symbols) {
+            auto symbol = table.findOrInsert(name);
+            if (!table.isDefined(symbol)) {
+                table.addVariable(symbol);
+                if (table.getAddress(symbol) >= screenAddress && variableError.empty()) {
+                    variableError = "variable " + std::string(name) + " would be allocated at " +
+                            std::to_string(table.getAddress(symbol)) + ", inside the SCREEN memory map";
+                }
+                variableCount++;
+            }
+            chunk.words[index] = table.getAddress(symbol);
+        }
+    }
+
+    if (info != nullptr) {
+        info->wordCount = wordCount;
+        info->variableCount = variableCount;
+    }
+    if (wordCount > romSize) {
+        throw AssemblyError{"program is " + std::to_string(wordCount) + " words but ROM holds " +
+                std::to_string(romSize)};
+    }
+    if (!variableError.empty()) {
+        throw AssemblyError{variableError};
+    }
+
+    std::vector<uint16_t> words{};
+    words.reserve(wordCount);
+    for (const auto& chunk : chunks) {
+        words.insert(words.end(), chunk.words.begin(), chunk.words.end());
+    }
+
+    return words;
+}
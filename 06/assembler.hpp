@@ -0,0 +1,41 @@
+#ifndef __assembler__
+#define __assembler__
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "invalid_command.hpp"
+#include "assembly_error.hpp"
+
+typedef std::vector<std::pair<std::string, std::size_t>> LabelList;
+
+struct AssemblyOptions {
+    // Large sources are split into up to this many chunks, which are
+    // parsed and encoded on their own threads
+    unsigned int jobs = 1;
+    // Run the peephole optimiser between parsing and encoding
+    bool optimise = false;
+};
+
+struct AssemblyInfo {
+    // Every label along with its ROM address, in program order
+    LabelList labels;
+    // ROM words removed by the peephole optimiser
+    std::size_t wordsSaved = 0;
+    // Size of the program in ROM words
+    std::size_t wordCount = 0;
+    // RAM words allocated to variables, starting from address 16
+    std::size_t variableCount = 0;
+};
+
+// Assembles Hack assembly source into machine words, throwing
+// InvalidCommand on malformed input and AssemblyError if the program
+// overflows ROM or its variables run into the SCREEN memory map. Calls
+// share no state, so separate programs can be assembled concurrently.
+// Symbols are resolved serially in program order, so the result does
+// not depend on options.jobs. On AssemblyError, info is still filled in.
+std::vector<uint16_t> assemble(std::string_view source, const AssemblyOptions& options = {}, AssemblyInfo* info = nullptr);
+
+#endif
@@ -1,84 +1,213 @@
+#include <atomic>
 #include <iostream>
 #include <fstream>
-#include <sstream>
+#include <map>
 #include <string>
-#include "parser.hpp"
-#include "code.hpp"
-#include "symbol_table.hpp"
+#include <memory>
+#include <thread>
+#include <vector>
+#include "boost/filesystem.hpp"
+#include "assembler.hpp"
+#include "hack_writer.hpp"
+#include "binary_writer.hpp"
+#include "size_report.hpp"
 
-std::string getFilename(std::string input)
+namespace fs = boost::filesystem;
+
+enum class OutputFormat { HACK, BIN };
+
+struct Options {
+    OutputFormat format;
+    bool withHeader;
+    bool optimise;
+    bool sizeReport;
+    unsigned int jobs;
+};
+
+// Outcome of assembling one file, reported once every file is done
+struct FileResult {
+    std::string error;
+    std::string report;
+};
+
+void usage()
 {
-    std::istringstream iss{input};
-    if (std::getline(iss, input, '.')) {
-        return input;
-    }
-    return "";
+    std::cerr << "USAGE: assemblr [--format=hack|bin] [--header] [-O] [--size-report] [-j jobs] input.asm..." << std::endl;
+    exit(1);
 };
 
-void buildSymbolTable(SymbolTable& table, Parser& parser)
+// The output sits next to its input with the extension swapped
+fs::path outputPath(const std::string& input, OutputFormat format)
 {
-    unsigned int instructionAddress = 0x0000;
+    return fs::path{input}.replace_extension(format == OutputFormat::BIN ? ".bin" : ".hack");
+};
 
-    while (parser.hasMoreCommands()) {
-        parser.advance();
-        Instruction instruction;
+// Two inputs writing to one output would overwrite each other, or race
+// when assembled in parallel, so refuse them up front. An input that would
+// be its own output is refused too.
+bool checkOutputs(const std::vector<std::string>& inputs, const std::vector<fs::path>& outputs)
+{
+    auto normal = [](const fs::path& path) { return fs::absolute(path).lexically_normal(); };
 
-        try {
-            instruction = parser.parse();
-        } catch (const InvalidCommand& e) {
-            std::cerr << "Invalid command: " << e.what() << std::endl;
-            exit(1);
-        }
+    std::map<fs::path, std::string> owners{};
+    for (const auto& input : inputs) {
+        owners.emplace(normal(input), input);
+    }
 
-        switch (instruction.type) {
-        case C_COMMAND:
-        case A_COMMAND:
-            instructionAddress++;
-            break;
-        case L_COMMAND:
-            table.addEntry(instruction.symbol, instructionAddress);
-            break;
+    bool ok = true;
+    for (std::size_t i = 0; i < inputs.size(); i++) {
+        auto output = normal(outputs[i]);
+        auto [owner, inserted] = owners.emplace(output, inputs[i]);
+        if (!inserted) {
+            auto other = output == normal(inputs[i]) ? "the input itself" : owner->second;
+            std::cerr << inputs[i] << ": output " << outputs[i].string() << " clashes with " << other << std::endl;
+            ok = false;
         }
     }
-}
+    return ok;
+};
 
-int  main(int argc, char* argv[])
+bool readSource(const std::string& path, std::string& source)
 {
-    if (argc != 2) {
-        std::cerr << "USAGE: assemblr input.asm" << std::endl;
-        exit(1);
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    if (!file) {
+        return false;
+    }
+
+    source.resize(file.tellg());
+    file.seekg(0);
+    file.read(source.data(), source.size());
+    return true;
+};
+
+FileResult assembleFile(const std::string& input, const fs::path& output, const Options& options, unsigned int jobs)
+{
+    FileResult result{};
+    std::string source;
+    if (!readSource(input, source)) {
+        result.error = "Could not open " + input;
+        return result;
+    }
+
+    AssemblyInfo info{};
+    std::vector<uint16_t> words;
+    try {
+        words = assemble(source, { jobs, options.optimise }, &info);
+    } catch (const InvalidCommand& e) {
+        result.error = std::string("Invalid command: ") + e.what();
+        return result;
+    } catch (const AssemblyError& e) {
+        // Still report sizes, which show where the space went
+        result.error = std::string("Error: ") + e.what();
+    }
+
+    if (options.optimise) {
+        result.report = "Peephole optimisation saved " + std::to_string(info.wordsSaved) + " words";
+    }
+    if (options.sizeReport) {
+        result.report += (result.report.empty() ? "" : "\n") + sizeReport(info);
+    }
+    if (!result.error.empty()) {
+        return result;
     }
-    auto input = argv[1];
-    std::ifstream program{input};
 
-    auto filename = getFilename(input);
-    std::ofstream out{filename + ".hack"};
+    std::ofstream out;
+    std::unique_ptr<Writer> writer;
+    if (options.format == OutputFormat::BIN) {
+        out.open(output.string(), std::ios::binary);
+        writer = std::make_unique<BinaryWriter>(out, options.withHeader);
+    } else {
+        out.open(output.string());
+        writer = std::make_unique<HackWriter>(out);
+    }
 
-    SymbolTable symbols{};
-    Parser symbolParser{program};
-    buildSymbolTable(symbols, symbolParser);
+    try {
+        for (const auto& [name, address] : info.labels) {
+            writer->label(name, address);
+        }
+        for (auto word : words) {
+            writer->write(word);
+        }
+        writer->close();
+    } catch (const AssemblyError& e) {
+        result.error = std::string("Error: ") + e.what();
+    }
+    out.close();
 
-    program.seekg(0);
-    Parser parser{program};
+    return result;
+};
 
-    while (parser.hasMoreCommands()) {
-        parser.advance();
-        Instruction instruction;
+int  main(int argc, char* argv[])
+{
+    Options options{ OutputFormat::HACK, false, false, false, std::max(1u, std::thread::hardware_concurrency()) };
+    std::vector<std::string> inputs{};
 
-        try {
-            instruction = parser.parse();
-        } catch (const InvalidCommand& e) {
-            std::cerr << "Invalid command: " << e.what() << std::endl;
-            exit(1);
+    for (int i = 1; i < argc; i++) {
+        std::string arg{argv[i]};
+        if (arg == "--format=hack") {
+            options.format = OutputFormat::HACK;
+        } else if (arg == "--format=bin") {
+            options.format = OutputFormat::BIN;
+        } else if (arg == "--header") {
+            options.withHeader = true;
+        } else if (arg == "-O") {
+            options.optimise = true;
+        } else if (arg == "--size-report") {
+            options.sizeReport = true;
+        } else if (arg == "-j" && i + 1 < argc) {
+            options.jobs = std::max(1, std::atoi(argv[++i]));
+        } else if (arg.rfind("-", 0) != 0) {
+            inputs.push_back(arg);
+        } else {
+            usage();
         }
+    }
 
-        auto code = Code{instruction, symbols};
-        if (instruction.type != L_COMMAND) {
-            out << code.string() << std::endl;
+    if (inputs.empty()) {
+        usage();
+    }
+
+    std::vector<fs::path> outputs{};
+    for (const auto& input : inputs) {
+        outputs.push_back(outputPath(input, options.format));
+    }
+    if (!checkOutputs(inputs, outputs)) {
+        return 1;
+    }
+
+    // Each file is assembled independently, so workers just take the next
+    // unclaimed input. Errors are kept per file and reported in input order.
+    // Any jobs left over once every file has a worker go to splitting files.
+    std::vector<FileResult> results(inputs.size());
+    std::atomic<std::size_t> nextInput{0};
+    auto jobsPerFile = std::max<std::size_t>(1, options.jobs / inputs.size());
+    auto worker = [&] {
+        for (auto i = nextInput++; i < inputs.size(); i = nextInput++) {
+            results[i] = assembleFile(inputs[i], outputs[i], options, jobsPerFile);
         }
+    };
+
+    std::vector<std::thread> workers{};
+    auto jobs = std::min<std::size_t>(options.jobs, inputs.size());
+    for (std::size_t i = 1; i < jobs; i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
     }
 
-    out.close();
+    bool failed = false;
+    for (std::size_t i = 0; i < inputs.size(); i++) {
+        auto prefix = inputs.size() > 1 ? inputs[i] + ": " : "";
+        if (!results[i].report.empty()) {
+            std::cout << prefix << results[i].report << std::endl;
+        }
+        if (!results[i].error.empty()) {
+            std::cerr << prefix << results[i].error << std::endl;
+            failed = true;
+        }
+    }
 
-    return 0;
+    return failed ? 1 : 0;
 };
@@ -0,0 +1,18 @@
+#ifndef __assembly_error__
+#define __assembly_error__
+
+#include <exception>
+#include <string>
+
+// A well-formed program that does not fit the Hack memory map
+class AssemblyError : public std::exception
+{
+ public:
+    AssemblyError(std::string message) : message(message) {}
+    ~AssemblyError() noexcept {}
+    virtual const char* what() const noexcept { return message.c_str(); }
+private:
+    std::string message;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#!/bin/bash
+# Writes a synthetic Hack program to stdout for benchmarking the
+# assembler.
+#
+# USAGE: generate_asm.sh lines labels variables
+#
+# The program is split into one block per label. Each block starts with
+# its label and jumps to the next block and to one further away, so
+# every label is referenced twice and most references come before the
+# definition. When variables > 0, each block also stores to one of that
+# many variables. The rest of each block is ordinary stack arithmetic.
+# Programs this size overflow ROM; the assembler still does all of its
+# parsing, encoding and symbol resolution before saying so.
+
+if [ $# -ne 3 ]; then
+    echo "USAGE: generate_asm.sh lines labels variables" >&2
+    exit 1
+fi
+
+awk -v lines="$1" -v labels="$2" -v variables="$3" 'BEGIN {
+    split("@SP AM=M-1 D=M A=A-1 M=D+M @LCL A=M D=M @5 D=D+A", filler, " ")
+    n = 0
+    for (k = 0; k < labels; k++) {
+        print "(L" k ")"
+        print "@L" (k + 1) % labels
+        print "D;JGT"
+        print "@L" (k * 7919) % labels
+        print "D;JEQ"
+        n += 5
+        if (variables > 0) {
+            print "@v" k % variables
+            print "M=D"
+            n += 2
+        }
+        for (end = int(lines * (k + 1) / labels); n < end; n++) {
+            print filler[n % 10 + 1]
+        }
+    }
+}'
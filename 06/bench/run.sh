@@ -0,0 +1,44 @@
+#!/bin/bash
+# Times an assembler binary on generated programs, best of three runs.
+# Any arguments after the binary are passed to it, so older builds
+# without the same options can be timed against the same inputs.
+#
+# USAGE: run.sh assemblr [args...]
+
+set -e
+
+if [ $# -lt 1 ]; then
+    echo "USAGE: run.sh assemblr [args...]" >&2
+    exit 1
+fi
+
+here=$(cd "$(dirname "$0")" && pwd)
+assembler=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+shift
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# name lines labels variables
+workloads=(
+    "plain 500000 500 16"
+    "symbols 700000 100000 5000"
+)
+
+for workload in "${workloads[@]}"; do
+    read -r name lines labels variables <<< "$workload"
+    "$here/generate_asm.sh" "$lines" "$labels" "$variables" > "$work/$name.asm"
+
+    best=
+    for run in 1 2 3; do
+        start=$(date +%s%N)
+        # Exits with 1 for ROM overflow once everything is resolved
+        "$assembler" "$@" "$work/$name.asm" > /dev/null 2>&1 || true
+        ms=$(( ($(date +%s%N) - start) / 1000000 ))
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+
+    echo "$name: $lines lines, $labels labels, $variables variables: $best ms ($(( lines * 1000 / (best > 0 ? best : 1) )) lines/s)"
+done
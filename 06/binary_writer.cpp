@@ -0,0 +1,93 @@
+#include <string>
+#include "assembly_error.hpp"
+#include "binary_writer.hpp"
+
+namespace {
+
+const uint16_t formatVersion = 1;
+const uint32_t headerSize = 24;
+const std::size_t bufferSize = 1 << 16;
+
+void put16(std::vector<char>& buffer, uint16_t value)
+{
+    buffer.push_back(static_cast<char>(value & 0xFF));
+    buffer.push_back(static_cast<char>(value >> 8));
+}
+
+void put32(std::vector<char>& buffer, uint32_t value)
+{
+    put16(buffer, static_cast<uint16_t>(value & 0xFFFF));
+    put16(buffer, static_cast<uint16_t>(value >> 16));
+}
+
+}
+
+BinaryWriter::BinaryWriter(std::ostream& output, bool withHeader)
+    : out(output), buffer{}, labels{}, withHeader(withHeader), wordCount(0)
+{
+    buffer.reserve(bufferSize);
+    if (withHeader) {
+        // Placeholder, rewritten by close() once the section sizes are known
+        writeHeader(0);
+    }
+};
+
+void BinaryWriter::write(uint16_t word)
+{
+    if (buffer.size() + 2 > bufferSize) {
+        flush();
+    }
+
+    put16(buffer, word);
+    wordCount++;
+};
+
+void BinaryWriter::label(std::string_view name, std::size_t address)
+{
+    if (address > UINT16_MAX) {
+        throw AssemblyError{"label " + std::string(name) + " at " + std::to_string(address) +
+                " does not fit the symbol section"};
+    }
+    if (withHeader) {
+        labels.emplace_back(name, static_cast<uint16_t>(address));
+    }
+};
+
+void BinaryWriter::close()
+{
+    flush();
+    if (!withHeader) {
+        return;
+    }
+
+    for (const auto& [name, address] : labels) {
+        put16(buffer, address);
+        put16(buffer, static_cast<uint16_t>(name.size()));
+        buffer.insert(buffer.end(), name.begin(), name.end());
+        if (buffer.size() > bufferSize) {
+            flush();
+        }
+    }
+    flush();
+
+    out.seekp(0);
+    writeHeader(headerSize + wordCount * 2);
+    flush();
+};
+
+void BinaryWriter::flush()
+{
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+};
+
+void BinaryWriter::writeHeader(uint32_t symbolOffset)
+{
+    buffer.insert(buffer.end(), { 'H', 'A', 'C', 'K' });
+    put16(buffer, formatVersion);
+    put16(buffer, static_cast<uint16_t>(headerSize));
+    put32(buffer, headerSize);
+    put32(buffer, wordCount);
+    put32(buffer, symbolOffset);
+    put32(buffer, static_cast<uint32_t>(labels.size()));
+};
@@ -0,0 +1,43 @@
+#ifndef __binary_writer__
+#define __binary_writer__
+
+#include <ostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "writer.hpp"
+
+// Writes machine words as packed little-endian 16-bit values, so a ROM
+// image can be loaded with a single read.
+//
+// With a header the file is laid out as follows, all integers little-endian:
+//
+//   offset  size  field
+//   0       4     magic "HACK"
+//   4       2     format version (1)
+//   6       2     header size in bytes
+//   8       4     code section offset
+//   12      4     code section size in words
+//   16      4     symbol section offset
+//   20      4     symbol count
+//
+// The symbol section lists each label as a 16-bit ROM address, a 16-bit
+// name length and the name's bytes. It follows the code section.
+class BinaryWriter : public Writer {
+public:
+    BinaryWriter(std::ostream& output, bool withHeader);
+    void write(uint16_t word) override;
+    // Throws AssemblyError if address does not fit the 16-bit field
+    void label(std::string_view name, std::size_t address) override;
+    void close() override;
+private:
+    void flush();
+    void writeHeader(uint32_t symbolOffset);
+    std::ostream& out;
+    std::vector<char> buffer;
+    std::vector<std::pair<std::string_view, uint16_t>> labels;
+    bool withHeader;
+    uint32_t wordCount;
+};
+
+#endif
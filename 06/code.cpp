@@ -1,102 +1,118 @@
-#include <sstream>
-#include <bitset>
-#include <iostream>
-#include <map>
+#include <charconv>
 #include "code.hpp"
 
-typedef std::map<std::string, std::string> CodeMap;
+namespace {
 
-CodeMap destCodes = {
-                     { "", "000" },
-                     { "M", "001" },
-                     { "D", "010" },
-                     { "MD", "011" },
-                     { "A", "100" },
-                     { "AM", "101" },
-                     { "AD", "110" },
-                     { "AMD", "111" }
-};
+// Packs a mnemonic of up to three characters into one integer so that
+// lookups are a switch over constants rather than a string comparison.
+constexpr uint32_t pack(std::string_view mnemonic)
+{
+    if (mnemonic.size() > 3) {
+        return UINT32_MAX;
+    }
 
-CodeMap jumpCodes = {
-                     { "", "000" },
-                     { "JGT", "001" },
-                     { "JEQ", "010" },
-                     { "JGE", "011" },
-                     { "JLT", "100" },
-                     { "JNE", "101" },
-                     { "JLE", "110" },
-                     { "JMP", "111" }
-};
+    uint32_t key = 0;
+    for (auto c : mnemonic) {
+        key = (key << 8) | static_cast<unsigned char>(c);
+    }
+    return key;
+}
 
-CodeMap compCodes = {
-                     { "0", "0101010" },
-                     { "1", "0111111" },
-                     { "-1", "0111010" },
-                     { "D", "0001100" },
-                     { "A", "0110000" },
-                     { "!D", "0001101" },
-                     { "!A", "0110001" },
-                     { "-D", "0001111" },
-                     { "-A", "0110011" },
-                     { "D+1", "0011111" },
-                     { "A+1", "0110111" },
-                     { "D-1", "0001110" },
-                     { "A-1", "0110010" },
-                     { "D+A", "0000010" },
-                     { "D-A", "0010011" },
-                     { "A-D", "0000111" },
-                     { "D&A", "0000000" },
-                     { "D|A", "0010101" },
-                     { "M", "1110000" },
-                     { "!M", "1110001" },
-                     { "-M", "1110011" },
-                     { "M+1", "1110111" },
-                     { "M-1", "1110010" },
-                     { "D+M", "1000010" },
-                     { "D-M", "1010011" },
-                     { "M-D", "1000111" },
-                     { "D&M", "1000000" },
-                     { "D|M", "1010101" }
-};
+uint16_t destBits(std::string_view dest)
+{
+    switch (pack(dest)) {
+    case pack(""):    return 0b000;
+    case pack("M"):   return 0b001;
+    case pack("D"):   return 0b010;
+    case pack("MD"):  return 0b011;
+    case pack("A"):   return 0b100;
+    case pack("AM"):  return 0b101;
+    case pack("AD"):  return 0b110;
+    case pack("AMD"): return 0b111;
+    }
+    throw InvalidCommand{"unknown dest " + std::string(dest)};
+}
 
-Code::Code(Instruction& instr, SymbolTable& mapping)
-    : mappings(mapping), instruction(instr)
+uint16_t jumpBits(std::string_view jump)
 {
-    switch (instr.type) {
-    case C_COMMAND:
-        dest = std::bitset<3>(destCodes[instr.dest]);
-        comp = std::bitset<7>(compCodes[instr.comp]);
-        jump = std::bitset<3>(jumpCodes[instr.jump]);
-        break;
-    case A_COMMAND:
-        try {
-            value = std::bitset<15>(std::stoi(instr.symbol));
-        } catch(const std::invalid_argument& e) {
-            // not a number
-            if (!mappings.contains(instr.symbol)) {
-                mappings.addVariable(instr.symbol);
-            }
-            value = std::bitset<15>(mappings.getAddress(instr.symbol));
-        }
-        break;
-    case L_COMMAND:
-        break;
+    switch (pack(jump)) {
+    case pack(""):    return 0b000;
+    case pack("JGT"): return 0b001;
+    case pack("JEQ"): return 0b010;
+    case pack("JGE"): return 0b011;
+    case pack("JLT"): return 0b100;
+    case pack("JNE"): return 0b101;
+    case pack("JLE"): return 0b110;
+    case pack("JMP"): return 0b111;
     }
+    throw InvalidCommand{"unknown jump " + std::string(jump)};
+}
+
+uint16_t compBits(std::string_view comp)
+{
+    switch (pack(comp)) {
+    case pack("0"):   return 0b0101010;
+    case pack("1"):   return 0b0111111;
+    case pack("-1"):  return 0b0111010;
+    case pack("D"):   return 0b0001100;
+    case pack("A"):   return 0b0110000;
+    case pack("!D"):  return 0b0001101;
+    case pack("!A"):  return 0b0110001;
+    case pack("-D"):  return 0b0001111;
+    case pack("-A"):  return 0b0110011;
+    case pack("D+1"): return 0b0011111;
+    case pack("A+1"): return 0b0110111;
+    case pack("D-1"): return 0b0001110;
+    case pack("A-1"): return 0b0110010;
+    case pack("D+A"):
+    case pack("A+D"): return 0b0000010;
+    case pack("D-A"): return 0b0010011;
+    case pack("A-D"): return 0b0000111;
+    case pack("D&A"):
+    case pack("A&D"): return 0b0000000;
+    case pack("D|A"):
+    case pack("A|D"): return 0b0010101;
+    case pack("M"):   return 0b1110000;
+    case pack("!M"):  return 0b1110001;
+    case pack("-M"):  return 0b1110011;
+    case pack("M+1"): return 0b1110111;
+    case pack("M-1"): return 0b1110010;
+    case pack("D+M"):
+    case pack("M+D"): return 0b1000010;
+    case pack("D-M"): return 0b1010011;
+    case pack("M-D"): return 0b1000111;
+    case pack("D&M"):
+    case pack("M&D"): return 0b1000000;
+    case pack("D|M"):
+    case pack("M|D"): return 0b1010101;
+    }
+    throw InvalidCommand{"unknown comp " + std::string(comp)};
+}
+
 }
 
-const std::string Code::string() const
+Code::Code(const Instruction& instr) : encoded(0), resolved(true)
 {
-    std::stringstream str;
-    switch (instruction.type) {
+    switch (instr.type) {
     case C_COMMAND:
-        str << "111" << comp.to_string() << dest.to_string() << jump.to_string();
+        encoded = 0b111 << 13 | compBits(instr.comp) << 6 | destBits(instr.dest) << 3 | jumpBits(instr.jump);
         break;
-    case A_COMMAND:
-        str << "0" << value.to_string();
+    case A_COMMAND: {
+        unsigned int value = 0;
+        auto first = instr.symbol.data();
+        auto result = std::from_chars(first, first + instr.symbol.size(), value);
+        if (result.ptr == first) {
+            // not a number
+            resolved = false;
+            break;
+        }
+        if (result.ec != std::errc() || value > 0x7FFF) {
+            throw InvalidCommand{"constant out of range @" + std::string(instr.symbol)};
+        }
+        encoded = value;
         break;
+    }
     case L_COMMAND:
         break;
     }
-    return str.str();
 }
-
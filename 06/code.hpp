@@ -1,22 +1,20 @@
 #ifndef __code__
 #define __code__
 
-#include <string>
+#include <cstdint>
 #include "parser.hpp"
-#include "symbol_table.hpp"
 
 class Code {
 public:
-    Code(Instruction& instr, SymbolTable& mapping);
+    Code(const Instruction& instr);
     ~Code() = default;
-    const std::string string() const;
+    uint16_t word() const noexcept { return encoded; };
+    // False for an A-instruction naming a symbol, whose address the
+    // caller must fill in from the symbol table
+    bool isResolved() const noexcept { return resolved; };
 private:
-    SymbolTable& mappings;
-    Instruction instruction;
-    std::bitset<3> dest;
-    std::bitset<7> comp;
-    std::bitset<3> jump;
-    std::bitset<15> value;
+    uint16_t encoded;
+    bool resolved;
 };
 
 #endif
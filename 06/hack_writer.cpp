@@ -0,0 +1,48 @@
+#include <array>
+#include <cstring>
+#include "hack_writer.hpp"
+
+namespace {
+
+const std::size_t lineLength = 17;
+const std::size_t bufferLines = 4096;
+
+// The eight ASCII digits for every byte value, most significant bit first
+const std::array<std::array<char, 8>, 256> byteDigits = [] {
+    std::array<std::array<char, 8>, 256> digits{};
+    for (std::size_t byte = 0; byte < 256; byte++) {
+        for (std::size_t bit = 0; bit < 8; bit++) {
+            digits[byte][bit] = (byte >> (7 - bit)) & 1 ? '1' : '0';
+        }
+    }
+    return digits;
+}();
+
+}
+
+HackWriter::HackWriter(std::ostream& output)
+    : out(output), buffer(lineLength * bufferLines), used(0) { };
+
+void HackWriter::close()
+{
+    flush();
+};
+
+void HackWriter::write(uint16_t word)
+{
+    if (used == buffer.size()) {
+        flush();
+    }
+
+    char* line = buffer.data() + used;
+    std::memcpy(line, byteDigits[word >> 8].data(), 8);
+    std::memcpy(line + 8, byteDigits[word & 0xFF].data(), 8);
+    line[16] = '\n';
+    used += lineLength;
+};
+
+void HackWriter::flush()
+{
+    out.write(buffer.data(), used);
+    used = 0;
+};
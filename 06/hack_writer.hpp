@@ -0,0 +1,22 @@
+#ifndef __hack_writer__
+#define __hack_writer__
+
+#include <ostream>
+#include <vector>
+#include "writer.hpp"
+
+// Formats machine words as lines of ASCII binary digits. Output is
+// collected in a reusable buffer and written to the stream in bulk.
+class HackWriter : public Writer {
+public:
+    HackWriter(std::ostream& output);
+    void write(uint16_t word) override;
+    void close() override;
+private:
+    void flush();
+    std::ostream& out;
+    std::vector<char> buffer;
+    std::size_t used;
+};
+
+#endif
@@ -1,4 +1,8 @@
+#ifndef __invalid_command__
+#define __invalid_command__
+
 #include <exception>
+#include <string>
 
 class InvalidCommand : public std::exception
 {
@@ -9,3 +13,5 @@ class InvalidCommand : public std::exception
 private:
     std::string command;
 };
+
+#endif
@@ -1,16 +1,68 @@
 #include <iostream>
 #include <algorithm>
+#include <array>
 #include "parser.hpp"
 
-const std::regex Parser::A_command{"^@([0-9]+|[a-zA-Z_\\.\\$0-9]+)"};
-const std::regex Parser::L_command{"\\(([a-zA-Z_\\.\\$0-9]+)\\)"};
-const std::regex Parser::C_command{"([A-Z]{1,3})=(.+);([A-Z]{3})"};
-const std::regex Parser::C_command_no_dest{"(.+);([A-Z]{3})"};
-const std::regex Parser::C_command_no_jump{"([A-Z]{1,3})=(.+)"};
+namespace {
 
-Parser::Parser(std::ifstream& input) : stream(input) { };
+// Character classes used by the instruction scanner, indexed by byte value.
+enum CharClass : unsigned char {
+    SYMBOL_CHAR = 1 << 0, // [a-zA-Z_.$0-9], valid in labels and variables
+    UPPER_CHAR = 1 << 1,  // [A-Z], valid in dest and jump mnemonics
+};
+
+constexpr std::array<unsigned char, 256> buildCharClasses()
+{
+    std::array<unsigned char, 256> classes{};
+    for (int c = 'a'; c <= 'z'; c++) {
+        classes[c] |= SYMBOL_CHAR;
+    }
+    for (int c = 'A'; c <= 'Z'; c++) {
+        classes[c] |= SYMBOL_CHAR | UPPER_CHAR;
+    }
+    for (int c = '0'; c <= '9'; c++) {
+        classes[c] |= SYMBOL_CHAR;
+    }
+    classes['_'] |= SYMBOL_CHAR;
+    classes['.'] |= SYMBOL_CHAR;
+    classes['$'] |= SYMBOL_CHAR;
+    return classes;
+}
+
+constexpr auto charClasses = buildCharClasses();
+
+inline bool is(CharClass cls, char c)
+{
+    return charClasses[static_cast<unsigned char>(c)] & cls;
+}
+
+// Returns the first position in [begin, end) that is not a symbol character
+const char* scanSymbol(const char* begin, const char* end)
+{
+    while (begin != end && is(SYMBOL_CHAR, *begin)) {
+        begin++;
+    }
+    return begin;
+}
+
+}
+
+Parser::Parser(char* begin, char* end) : lines{}, nextLine(0)
+{
+    while (begin != end) {
+        auto lineEnd = std::find(begin, end, '\n');
+        auto line = sanitise(begin, lineEnd);
+
+        // Skip empty lines
+        if (!line.empty()) {
+            lines.push_back(line);
+        }
 
-const Instruction Parser::parse() throw(InvalidCommand)
+        begin = lineEnd == end ? end : lineEnd + 1;
+    }
+};
+
+const Instruction Parser::parse()
 {
     auto type = commandType();
     Instruction instruction{.type = type};
@@ -26,112 +78,132 @@ const Instruction Parser::parse() throw(InvalidCommand)
     return instruction;
 }
 
-bool Parser::hasMoreCommands() noexcept
+bool Parser::hasMoreCommands() const noexcept
 {
-    auto c = stream.peek();
-    if (c == EOF) {
-        return false;
-    }
-    return true;
+    return nextLine < lines.size();
 };
 
 void Parser::advance()
 {
-    std::string input;
-    std::getline(stream, input);
-    currentLine = sanitise(input);
-
-    // Skip empty lines
-    if (currentLine.length() == 0) {
-        advance();
-    }
+    currentLine = lines[nextLine++];
 };
 
-CommandType const Parser::commandType() throw(InvalidCommand)
+CommandType const Parser::commandType()
 {
-    std::smatch match;
+    const char* begin = currentLine.data();
+    const char* end = begin + currentLine.size();
 
-    if (std::regex_match(currentLine, match, A_command)) {
-        if (match.size() == 2) {
-            A_value = match[1].str();
+    switch (*begin) {
+    case '@': {
+        // @value | @symbol
+        auto symbolEnd = scanSymbol(begin + 1, end);
+        if (symbolEnd == end && symbolEnd != begin + 1) {
+            A_value = std::string_view(begin + 1, end - begin - 1);
 
             return CommandType::A_COMMAND;
         }
+        break;
     }
-
-    if (std::regex_match(currentLine, match, L_command)) {
-        if (match.size() == 2) {
-            A_value = match[1].str();
+    case '(': {
+        // (LABEL)
+        auto symbolEnd = scanSymbol(begin + 1, end);
+        if (symbolEnd != begin + 1 && symbolEnd + 1 == end && *symbolEnd == ')') {
+            A_value = std::string_view(begin + 1, symbolEnd - begin - 1);
 
             return CommandType::L_COMMAND;
         }
+        break;
+    }
+    default:
+        if (scanCommand(begin, end)) {
+            return CommandType::C_COMMAND;
+        }
+        break;
     }
 
-    if (std::regex_match(currentLine, match, C_command)) {
-        if (match.size() == 4) {
-            C_dest = match[1].str();
-            C_comp = match[2].str();
-            C_jump = match[3].str();
+    throw InvalidCommand{std::string(currentLine)};
+};
 
-            return CommandType::C_COMMAND;
+bool Parser::scanCommand(const char* begin, const char* end)
+{
+    // dest=comp;jump | comp;jump | dest=comp
+    const char* equals = nullptr;
+    const char* semicolon = nullptr;
+    const char* destEnd = begin;
+
+    for (auto it = begin; it != end; it++) {
+        if (*it == '=' && equals == nullptr) {
+            equals = it;
+        } else if (*it == ';') {
+            semicolon = it;
+        }
+        if (destEnd == it && is(UPPER_CHAR, *it)) {
+            destEnd++;
         }
     }
 
-    if (std::regex_match(currentLine, match, C_command_no_dest)) {
-        if (match.size() == 3) {
-            C_comp = match[1].str();
-            C_jump = match[2].str();
+    bool hasDest = equals != nullptr && equals != begin && equals == destEnd && equals - begin <= 3;
+    bool hasJump = semicolon != nullptr && end - semicolon == 4 &&
+        is(UPPER_CHAR, semicolon[1]) && is(UPPER_CHAR, semicolon[2]) && is(UPPER_CHAR, semicolon[3]);
 
-            C_dest = "";
+    if (hasDest && hasJump && semicolon - equals > 1) {
+        C_dest = std::string_view(begin, equals - begin);
+        C_comp = std::string_view(equals + 1, semicolon - equals - 1);
+        C_jump = std::string_view(semicolon + 1, end - semicolon - 1);
 
-            return CommandType::C_COMMAND;
-        }
+        return true;
     }
 
-    if (std::regex_match(currentLine, match, C_command_no_jump)) {
-        if (match.size() == 3) {
-            C_dest = match[1].str();
-            C_comp = match[2].str();
+    // No comp mnemonic contains '=' or ';', so a stray one is an error
+    // rather than part of comp
+    if (hasJump && semicolon != begin && equals == nullptr) {
+        C_dest = std::string_view{};
+        C_comp = std::string_view(begin, semicolon - begin);
+        C_jump = std::string_view(semicolon + 1, end - semicolon - 1);
 
-            C_jump = "";
+        return true;
+    }
 
-            return CommandType::C_COMMAND;
-        }
+    if (hasDest && end - equals > 1 && semicolon == nullptr) {
+        C_dest = std::string_view(begin, equals - begin);
+        C_comp = std::string_view(equals + 1, end - equals - 1);
+        C_jump = std::string_view{};
+
+        return true;
     }
 
-    throw InvalidCommand{currentLine};
+    return false;
 };
 
-const std::string& Parser::symbol() const
+std::string_view Parser::symbol() const
 {
     return A_value;
 };
 
-const std::string& Parser::dest() const
+std::string_view Parser::dest() const
 {
     return C_dest;
 };
 
-const std::string& Parser::comp() const
+std::string_view Parser::comp() const
 {
     return C_comp;
 };
 
-const std::string& Parser::jump() const
+std::string_view Parser::jump() const
 {
     return C_jump;
 };
 
-std::string Parser::sanitise(std::string s)
+// Strips whitespace and comments by compacting the line in place
+std::string_view Parser::sanitise(char* begin, char* end)
 {
-    s.erase(std::remove_if(
-                           s.begin(),
-                           s.end(),
-                           [](unsigned char x) { return std::isspace(x); }),
-            s.end());
-    auto commentPos = s.find("//");
-    if (commentPos != std::string::npos) {
-        s.erase(commentPos);
+    end = std::remove_if(begin, end, [](unsigned char x) { return std::isspace(x); });
+
+    std::string_view line(begin, end - begin);
+    auto commentPos = line.find("//");
+    if (commentPos != std::string_view::npos) {
+        line.remove_suffix(line.size() - commentPos);
     }
-    return s;
+    return line;
 };
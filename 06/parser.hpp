@@ -1,42 +1,43 @@
 #ifndef __parser__
 #define __parser__
 
-#include <regex>
 #include <string>
-#include <fstream>
+#include <string_view>
+#include <vector>
 #include "invalid_command.hpp"
 
 enum CommandType { A_COMMAND, C_COMMAND, L_COMMAND };
 
+// Fields are views into the source buffer the Parser was built from
 struct Instruction {
     CommandType type;
-    std::string symbol;
-    std::string dest;
-    std::string comp;
-    std::string jump;
+    std::string_view symbol;
+    std::string_view dest;
+    std::string_view comp;
+    std::string_view jump;
 };
 
 class Parser {
 public:
-    Parser(std::ifstream&);
+    // Sanitises the lines of [begin, end) in place and indexes the
+    // non-empty ones, so the buffer must outlive the Parser and every
+    // Instruction it returns.
+    Parser(char* begin, char* end);
     ~Parser() = default;
-    bool hasMoreCommands() noexcept;
+    bool hasMoreCommands() const noexcept;
     void advance();
-    const Instruction parse() throw(InvalidCommand);
+    const Instruction parse();
 private:
-    CommandType const commandType() throw(InvalidCommand);
-    const std::string& symbol() const;
-    const std::string& dest() const;
-    const std::string& comp() const;
-    const std::string& jump() const;
-    std::string sanitise(std::string);
-    std::ifstream& stream;
-    std::string currentLine, A_value, C_dest, C_comp, C_jump;
-    static const std::regex A_command;
-    static const std::regex L_command;
-    static const std::regex C_command;
-    static const std::regex C_command_no_dest;
-    static const std::regex C_command_no_jump;
+    CommandType const commandType();
+    bool scanCommand(const char* begin, const char* end);
+    std::string_view symbol() const;
+    std::string_view dest() const;
+    std::string_view comp() const;
+    std::string_view jump() const;
+    std::string_view sanitise(char* begin, char* end);
+    std::vector<std::string_view> lines;
+    std::size_t nextLine;
+    std::string_view currentLine, A_value, C_dest, C_comp, C_jump;
 };
 
 #endif
@@ -0,0 +1,132 @@
+#include "peephole.hpp"
+
+namespace {
+
+bool isC(const Instruction& instr, std::string_view dest, std::string_view comp)
+{
+    return instr.type == C_COMMAND && instr.dest == dest && instr.comp == comp && instr.jump.empty();
+}
+
+std::size_t countWords(const std::vector<Instruction>& instructions)
+{
+    std::size_t words = 0;
+    for (const auto& instr : instructions) {
+        if (instr.type != L_COMMAND) {
+            words++;
+        }
+    }
+    return words;
+}
+
+// The symbol A is known to hold after the last instruction in out, if any
+const Instruction* loadedAddress(const std::vector<Instruction>& out)
+{
+    for (auto it = out.rbegin(); it != out.rend(); it++) {
+        switch (it->type) {
+        case A_COMMAND:
+            return &*it;
+        case L_COMMAND:
+            return nullptr;
+        case C_COMMAND:
+            if (it->dest.find('A') != std::string_view::npos) {
+                return nullptr;
+            }
+            break;
+        }
+    }
+    return nullptr;
+}
+
+// M=M+1 immediately followed by M=M-1 or AM=M-1 at the end of out, or
+// the same with the signs swapped. A is unchanged in between, so the two
+// cancel out. Reloads of A between them have already been dropped.
+bool cancelIncrement(std::vector<Instruction>& out)
+{
+    auto n = out.size();
+    if (n < 2) {
+        return false;
+    }
+
+    const auto& first = out[n - 2];
+    const auto& second = out[n - 1];
+    bool cancels = (isC(first, "M", "M+1") && (isC(second, "M", "M-1") || isC(second, "AM", "M-1"))) ||
+        (isC(first, "M", "M-1") && (isC(second, "M", "M+1") || isC(second, "AM", "M+1")));
+    if (!cancels) {
+        return false;
+    }
+
+    bool loadsA = second.dest == "AM";
+    out.resize(n - 2);
+    if (loadsA) {
+        out.push_back(Instruction{ C_COMMAND, {}, "A", "M", {} });
+    }
+    return true;
+}
+
+// @L, comp;jump followed by a run of labels that includes (L)
+bool dropJumpToNext(std::vector<Instruction>& out)
+{
+    auto labelsBegin = out.size();
+    while (labelsBegin > 0 && out[labelsBegin - 1].type == L_COMMAND) {
+        labelsBegin--;
+    }
+    if (labelsBegin < 2) {
+        return false;
+    }
+
+    const auto& jump = out[labelsBegin - 1];
+    const auto& target = out[labelsBegin - 2];
+    if (jump.type != C_COMMAND || jump.jump.empty() || !jump.dest.empty() || target.type != A_COMMAND) {
+        return false;
+    }
+
+    for (auto i = labelsBegin; i < out.size(); i++) {
+        if (out[i].symbol == target.symbol) {
+            out.erase(out.begin() + labelsBegin - 2, out.begin() + labelsBegin);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool optimisePass(std::vector<Instruction>& instructions)
+{
+    std::vector<Instruction> out{};
+    out.reserve(instructions.size());
+    bool changed = false;
+
+    for (const auto& instr : instructions) {
+        if (instr.type == A_COMMAND) {
+            auto loaded = loadedAddress(out);
+            if (loaded != nullptr && loaded->symbol == instr.symbol) {
+                changed = true;
+                continue;
+            }
+        }
+
+        out.push_back(instr);
+
+        switch (instr.type) {
+        case C_COMMAND:
+            changed |= cancelIncrement(out);
+            break;
+        case L_COMMAND:
+            changed |= dropJumpToNext(out);
+            break;
+        case A_COMMAND:
+            break;
+        }
+    }
+
+    instructions.swap(out);
+    return changed;
+}
+
+}
+
+std::size_t optimise(std::vector<Instruction>& instructions)
+{
+    auto before = countWords(instructions);
+    while (optimisePass(instructions)) { }
+    return before - countWords(instructions);
+}
@@ -0,0 +1,20 @@
+#ifndef __peephole__
+#define __peephole__
+
+#include <vector>
+#include "parser.hpp"
+
+// Rewrites the instruction stream in place to remove instructions with no
+// effect, returning how many ROM words were saved:
+//
+//   @X when A already holds X is dropped
+//   M=M+1, M=M-1 with A unchanged between them is dropped
+//   M=M+1, AM=M-1 with A unchanged between them becomes A=M
+//   (and likewise with the signs swapped)
+//   @L, comp;jump directly before (L) is dropped
+//
+// Code after a label is assumed not to rely on the value of A when it is
+// reached by falling through, as is true of the VM translator's output.
+std::size_t optimise(std::vector<Instruction>& instructions);
+
+#endif
@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include "size_report.hpp"
+
+namespace {
+
+const std::size_t romSize = 32768;
+const std::size_t variableBase = 16;
+
+bool isFunction(const std::string& label)
+{
+    auto dot = label.find('.');
+    return dot != std::string::npos && dot != 0 && dot + 1 != label.size() &&
+        label.find('.', dot + 1) == std::string::npos && label.find('$') == std::string::npos;
+}
+
+}
+
+std::string sizeReport(const AssemblyInfo& info)
+{
+    std::map<std::string, std::size_t> sizes{};
+    std::string current = "(start)";
+    std::size_t start = 0;
+
+    for (const auto& [label, address] : info.labels) {
+        if (isFunction(label)) {
+            sizes[current] += address - start;
+            current = label;
+            start = address;
+        }
+    }
+    sizes[current] += info.wordCount - start;
+
+    std::vector<std::pair<std::string, std::size_t>> sorted(sizes.begin(), sizes.end());
+    std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second > b.second;
+    });
+
+    std::ostringstream report;
+    report << "ROM: " << info.wordCount << " of " << romSize << " words ("
+           << std::fixed << std::setprecision(1) << 100.0 * info.wordCount / romSize << "%)" << std::endl;
+    report << "RAM variables: " << info.variableCount << " words";
+    if (info.variableCount > 0) {
+        report << " (" << variableBase << "-" << variableBase + info.variableCount - 1 << ")";
+    }
+    report << std::endl;
+    report << std::setw(7) << "words" << "  function" << std::endl;
+    for (const auto& [name, words] : sorted) {
+        if (words > 0) {
+            report << std::setw(7) << words << "  " << name << std::endl;
+        }
+    }
+
+    auto text = report.str();
+    text.pop_back();
+    return text;
+}
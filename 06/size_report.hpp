@@ -0,0 +1,14 @@
+#ifndef __size_report__
+#define __size_report__
+
+#include <string>
+#include "assembler.hpp"
+
+// Summarises ROM and RAM use, with the ROM words used by each function
+// from largest to smallest. A function starts at a label of the form
+// Class.name, as written by the VM translator. Any other label, such as
+// Class.name$loop or a return address, counts towards the function it
+// appears in, and code before the first function counts as "(start)".
+std::string sizeReport(const AssemblyInfo& info);
+
+#endif
@@ -1,9 +1,29 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
 #include "symbol_table.hpp"
-#include <iostream>
 
-unsigned int SymbolTable::currentVariableAddress = 0x0010;
+namespace {
 
-SymbolTable::SymbolTable() : mapping{}
+const std::size_t initialSlots = 1024;
+const std::size_t arenaBlockSize = 64 * 1024;
+const SymbolId emptySlot = UINT32_MAX;
+
+// FNV-1a
+uint32_t hashOf(std::string_view symbol)
+{
+    uint32_t hash = 2166136261u;
+    for (auto c : symbol) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+}
+
+SymbolTable::SymbolTable()
+    : entries{}, slots(initialSlots, emptySlot), arena{}, arenaCursor(nullptr), arenaRemaining(0),
+      currentVariableAddress(0x0010)
 {
     addEntry("SP", 0x0000);
     addEntry("LCL", 0x0001);
@@ -18,23 +38,88 @@ SymbolTable::SymbolTable() : mapping{}
     }
 }
 
-void SymbolTable::addEntry(std::string symbol, unsigned int address)
+SymbolId SymbolTable::findOrInsert(std::string_view symbol)
 {
-    mapping.emplace(symbol, address);
+    auto hash = hashOf(symbol);
+    auto mask = slots.size() - 1;
+
+    for (auto slot = hash & mask; ; slot = (slot + 1) & mask) {
+        auto id = slots[slot];
+        if (id == emptySlot) {
+            id = static_cast<SymbolId>(entries.size());
+            entries.push_back(Entry{ intern(symbol), hash, 0, false });
+            slots[slot] = id;
+            // Keep the load factor at or below one half
+            if (entries.size() * 2 > slots.size()) {
+                grow();
+            }
+            return id;
+        }
+        const auto& entry = entries[id];
+        if (entry.hash == hash && entry.name == symbol) {
+            return id;
+        }
+    }
 }
 
-void SymbolTable::addVariable(std::string symbol)
+void SymbolTable::addEntry(std::string_view symbol, unsigned int address)
 {
-    addEntry(symbol, currentVariableAddress++);
+    auto& entry = entries[findOrInsert(symbol)];
+    if (!entry.defined) {
+        entry.address = address;
+        entry.defined = true;
+    }
 }
 
-bool SymbolTable::contains(std::string symbol)
+void SymbolTable::addVariable(SymbolId id)
 {
-    auto search = mapping.find(symbol);
-    return search != mapping.end();
+    entries[id].address = currentVariableAddress++;
+    entries[id].defined = true;
 }
 
-unsigned int SymbolTable::getAddress(std::string symbol)
+bool SymbolTable::isDefined(SymbolId id) const noexcept
 {
-    return mapping[symbol];
+    return entries[id].defined;
+}
+
+unsigned int SymbolTable::getAddress(SymbolId id) const noexcept
+{
+    return entries[id].address;
+}
+
+std::string_view SymbolTable::name(SymbolId id) const noexcept
+{
+    return entries[id].name;
+}
+
+std::string_view SymbolTable::intern(std::string_view symbol)
+{
+    if (symbol.size() > arenaRemaining) {
+        auto blockSize = std::max(arenaBlockSize, symbol.size());
+        arena.push_back(std::make_unique<char[]>(blockSize));
+        arenaCursor = arena.back().get();
+        arenaRemaining = blockSize;
+    }
+
+    std::memcpy(arenaCursor, symbol.data(), symbol.size());
+    std::string_view interned(arenaCursor, symbol.size());
+    arenaCursor += symbol.size();
+    arenaRemaining -= symbol.size();
+    return interned;
+}
+
+void SymbolTable::grow()
+{
+    std::vector<SymbolId> grown(slots.size() * 2, emptySlot);
+    auto mask = grown.size() - 1;
+
+    for (SymbolId id = 0; id < entries.size(); id++) {
+        auto slot = entries[id].hash & mask;
+        while (grown[slot] != emptySlot) {
+            slot = (slot + 1) & mask;
+        }
+        grown[slot] = id;
+    }
+
+    slots.swap(grown);
 }
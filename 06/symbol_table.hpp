@@ -1,20 +1,44 @@
 #ifndef __symbol_table__
 #define __symbol_table__
 
-#include <string>
-#include <map>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
 
+typedef uint32_t SymbolId;
+
+// Open-addressing hash table from symbol names to addresses. Names are
+// interned into an arena owned by the table, and each distinct name gets
+// a stable SymbolId, so callers look a symbol up once and keep the id.
 class SymbolTable {
 public:
     SymbolTable();
     ~SymbolTable() = default;
-    void addEntry(std::string, unsigned int);
-    void addVariable(std::string);
-    bool contains(std::string);
-    unsigned int getAddress(std::string);
+    // Returns the id for symbol, adding it undefined if it is new
+    SymbolId findOrInsert(std::string_view symbol);
+    // Defines symbol at address unless it is already defined
+    void addEntry(std::string_view symbol, unsigned int address);
+    // Defines symbol at the next free variable address
+    void addVariable(SymbolId id);
+    bool isDefined(SymbolId id) const noexcept;
+    unsigned int getAddress(SymbolId id) const noexcept;
+    std::string_view name(SymbolId id) const noexcept;
 private:
-    std::map<std::string, unsigned int> mapping;
-    static unsigned int currentVariableAddress;
+    struct Entry {
+        std::string_view name;
+        uint32_t hash;
+        unsigned int address;
+        bool defined;
+    };
+    std::string_view intern(std::string_view symbol);
+    void grow();
+    std::vector<Entry> entries;
+    std::vector<SymbolId> slots;
+    std::vector<std::unique_ptr<char[]>> arena;
+    char* arenaCursor;
+    std::size_t arenaRemaining;
+    unsigned int currentVariableAddress;
 };
 
 #endif
@@ -0,0 +1,90 @@
+// Checks how the parser splits well-formed lines and which malformed
+// lines it rejects with InvalidCommand. Run with make check.
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "parser.hpp"
+
+namespace {
+
+int failures = 0;
+
+void fail(std::string_view line, const std::string& message)
+{
+    std::cerr << "FAIL \"" << line << "\": " << message << std::endl;
+    failures++;
+};
+
+// Parses a single line, which must not throw
+Instruction parseLine(std::string& buffer)
+{
+    Parser parser{buffer.data(), buffer.data() + buffer.size()};
+    parser.advance();
+    return parser.parse();
+};
+
+void accepts(std::string_view line, CommandType type, std::string_view first,
+        std::string_view comp = {}, std::string_view jump = {})
+{
+    std::string buffer{line};
+    try {
+        auto instruction = parseLine(buffer);
+        auto field = type == C_COMMAND ? instruction.dest : instruction.symbol;
+        if (instruction.type != type || field != first || instruction.comp != comp || instruction.jump != jump) {
+            fail(line, "split into " + std::string(field) + " | " + std::string(instruction.comp) +
+                    " | " + std::string(instruction.jump));
+        }
+    } catch (const InvalidCommand& e) {
+        fail(line, std::string("rejected: ") + e.what());
+    }
+};
+
+void rejects(std::string_view line)
+{
+    std::string buffer{line};
+    try {
+        parseLine(buffer);
+        fail(line, "accepted");
+    } catch (const InvalidCommand&) {
+    }
+};
+
+}
+
+int main()
+{
+    accepts("@21", A_COMMAND, "21");
+    accepts("@Main.loop$END", A_COMMAND, "Main.loop$END");
+    accepts("(LOOP)", L_COMMAND, "LOOP");
+    accepts("D=M", C_COMMAND, "D", "M");
+    accepts("AMD=D+1;JMP", C_COMMAND, "AMD", "D+1", "JMP");
+    accepts("0;JMP", C_COMMAND, "", "0", "JMP");
+    accepts("  M = M + 1  // increment", C_COMMAND, "M", "M+1");
+
+    // Malformed A- and L-commands
+    rejects("@");
+    rejects("@a-b");
+    rejects("()");
+    rejects("(LOOP");
+    rejects("(LOOP)x");
+
+    // Malformed C-commands
+    rejects("D");
+    rejects("D=");
+    rejects("=D");
+    rejects("=D;JMP");
+    rejects("D=;JMP");
+    rejects("AMDX=D");
+    rejects("d=M");
+    rejects(";JMP");
+    rejects("0;JM");
+    rejects("0;JMPX");
+
+    if (failures > 0) {
+        std::cerr << failures << " parser checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "parser checks passed" << std::endl;
+    return 0;
+};
@@ -0,0 +1,19 @@
+#ifndef __writer__
+#define __writer__
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Destination for assembled machine words
+class Writer {
+public:
+    virtual ~Writer() = default;
+    virtual void write(uint16_t word) = 0;
+    // Records that label name resolves to ROM address
+    virtual void label(std::string_view name, std::size_t address) { };
+    // Writes out anything still buffered; no more words may follow
+    virtual void close() = 0;
+};
+
+#endif
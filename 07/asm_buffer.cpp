@@ -0,0 +1,24 @@
+#include <charconv>
+#include "asm_buffer.hpp"
+
+AsmBuffer::AsmBuffer(std::size_t capacity)
+{
+    text.reserve(capacity);
+};
+
+std::string_view AsmBuffer::view() const noexcept
+{
+    return text;
+};
+
+void AsmBuffer::append(std::string_view part)
+{
+    text.append(part);
+};
+
+void AsmBuffer::append(int number)
+{
+    char digits[12];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    text.append(digits, result.ptr);
+};
@@ -0,0 +1,26 @@
+#ifndef __asm_buffer__
+#define __asm_buffer__
+
+#include <string>
+#include <string_view>
+
+// Collects generated assembly in one growing string. A line is appended
+// piece by piece from string_views and integers, so writing it allocates
+// nothing unless the buffer itself has to grow.
+class AsmBuffer {
+public:
+    explicit AsmBuffer(std::size_t capacity = 0);
+    template<typename... Parts>
+    void line(const Parts&... parts)
+    {
+        (append(parts), ...);
+        text.push_back('\n');
+    };
+    std::string_view view() const noexcept;
+private:
+    void append(std::string_view part);
+    void append(int number);
+    std::string text;
+};
+
+#endif
@@ -0,0 +1,28 @@
+#!/bin/bash
+# Writes a synthetic .vm file of about the given number of lines to
+# stdout, for benchmarking the translator. Each function is a loop over
+# the usual mix of compiler output: segment pushes and pops, arithmetic,
+# comparisons, branches and calls.
+#
+# USAGE: generate_vm.sh lines
+
+if [ $# -ne 1 ]; then
+    echo "USAGE: generate_vm.sh lines" >&2
+    exit 1
+fi
+
+awk -v lines="$1" 'BEGIN {
+    n = split("push argument 0|push constant 7|add|pop local 0|label LOOP|" \
+        "push local 0|push constant 1|sub|pop local 0|push local 0|push constant 0|gt|not|" \
+        "if-goto END|push static 3|push this 1|call Math.multiply 2|pop temp 0|" \
+        "push local 1|push that 0|add|pop pointer 1|push constant 0|pop that 0|" \
+        "goto LOOP|label END|push local 0|return", body, "|")
+    for (k = 0; written < lines; k++) {
+        print "// function " k
+        print "function Bench.f" k " 2"
+        for (i = 1; i <= n; i++) {
+            print "    " body[i]
+        }
+        written += n + 2
+    }
+}'
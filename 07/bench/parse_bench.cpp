@@ -0,0 +1,45 @@
+// Times the VM parser alone on one file, best of three runs.
+// USAGE: parse_bench input.vm
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include "parser.hpp"
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2) {
+        std::cerr << "USAGE: parse_bench input.vm" << std::endl;
+        return 1;
+    }
+
+    std::ifstream input{argv[1], std::ios::binary};
+    std::string source{std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+    if (!input) {
+        std::cerr << "Could not open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    double best = 0;
+    std::size_t commands = 0;
+    for (int run = 0; run < 3; run++) {
+        auto start = std::chrono::steady_clock::now();
+        StringPool symbols{};
+        Parser parser{source, symbols};
+        commands = 0;
+        while (parser.hasMoreCommands()) {
+            parser.advance();
+            parser.parse();
+            commands++;
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (run == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+
+    std::cout << "parse: " << commands << " commands in " << static_cast<long>(best) << " ms" << std::endl;
+    return 0;
+};
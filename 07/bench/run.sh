@@ -0,0 +1,29 @@
+#!/bin/bash
+# Generates a million-line .vm file and times the parser alone, then the
+# whole translator, on it. Expects parse_bench and vm_bench in 07, which
+# make bench builds first.
+
+set -e
+
+here=$(cd "$(dirname "$0")" && pwd)
+root=$(dirname "$here")
+lines=${LINES:-1000000}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+"$here/generate_vm.sh" "$lines" > "$work/Bench.vm"
+echo "input: $(wc -l < "$work/Bench.vm") lines"
+
+"$root/parse_bench" "$work/Bench.vm"
+
+best=
+for run in 1 2 3; do
+    start=$(date +%s%N)
+    (cd "$work" && "$root/vm_bench" Bench.vm > /dev/null)
+    ms=$(( ($(date +%s%N) - start) / 1000000 ))
+    if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+        best=$ms
+    fi
+done
+echo "translate: $best ms"
@@ -0,0 +1,99 @@
+#include <map>
+#include <sstream>
+#include "call_graph.hpp"
+
+namespace {
+
+typedef std::map<std::string, std::vector<std::string>> CallGraph;
+
+CallGraph buildCallGraph(const std::vector<VmFile>& files)
+{
+    CallGraph graph{};
+    for (const auto& file : files) {
+        std::vector<std::string>* callees = nullptr;
+        for (const auto& command : file.commands) {
+            if (command.type == CommandType::C_FUNCTION) {
+                callees = &graph[std::string(file.symbols.name(command.symbol))];
+            } else if (command.type == CommandType::C_CALL && callees) {
+                callees->emplace_back(file.symbols.name(command.symbol));
+            }
+        }
+    }
+    return graph;
+};
+
+}
+
+FunctionSet reachableFunctions(const std::vector<VmFile>& files)
+{
+    auto graph = buildCallGraph(files);
+    FunctionSet reachable{};
+
+    if (graph.find("Sys.init") == graph.end()) {
+        for (const auto& [function, callees] : graph) {
+            reachable.insert(function);
+        }
+        return reachable;
+    }
+
+    std::vector<std::string> pending{ "Sys.init" };
+    reachable.insert("Sys.init");
+    while (!pending.empty()) {
+        auto function = pending.back();
+        pending.pop_back();
+
+        auto node = graph.find(function);
+        if (node == graph.end()) {
+            continue;
+        }
+        for (const auto& callee : node->second) {
+            if (reachable.insert(callee).second) {
+                pending.push_back(callee);
+            }
+        }
+    }
+
+    return reachable;
+};
+
+std::string reachabilityReport(const std::vector<VmFile>& files, const FunctionSet& reachable)
+{
+    std::size_t functions = 0, kept = 0, commands = 0, keptCommands = 0;
+    std::ostringstream removed{};
+
+    for (const auto& file : files) {
+        std::string function{};
+        std::size_t length = 0;
+        auto finish = [&] {
+            if (function.empty()) {
+                return;
+            }
+            functions++;
+            commands += length;
+            if (reachable.count(function)) {
+                kept++;
+                keptCommands += length;
+            } else {
+                removed << "\n  - " << function << " (" << length << " commands)";
+            }
+        };
+
+        for (const auto& command : file.commands) {
+            if (command.type == CommandType::C_FUNCTION) {
+                finish();
+                function = file.symbols.name(command.symbol);
+                length = 0;
+            }
+            length++;
+        }
+        finish();
+    }
+
+    std::ostringstream report{};
+    report << "Reachable functions: " << kept << " of " << functions
+           << " (" << keptCommands << " of " << commands << " commands)";
+    if (kept < functions) {
+        report << "\nUnreachable:" << removed.str();
+    }
+    return report.str();
+};
@@ -0,0 +1,18 @@
+#ifndef __call_graph__
+#define __call_graph__
+
+#include <set>
+#include <string>
+#include <vector>
+#include "parser.hpp"
+
+typedef std::set<std::string> FunctionSet;
+
+// Functions reachable through calls from Sys.init, which the bootstrap
+// calls. Every function is reachable in a program without Sys.init.
+FunctionSet reachableFunctions(const std::vector<VmFile>& files);
+
+// Counts of kept and removed functions, listing the removed ones
+std::string reachabilityReport(const std::vector<VmFile>& files, const FunctionSet& reachable);
+
+#endif
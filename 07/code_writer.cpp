@@ -1,66 +1,312 @@
-#include <map>
+#include <array>
+#include <charconv>
 #include "code_writer.hpp"
 
-typedef std::map<std::string, std::string> CommandMap;
+// Base pointers of the argument, local, this and that segments
+const std::array<std::string_view, 4> segmentPointers = { "ARG", "LCL", "THIS", "THAT" };
 
-CommandMap addresses = {
-    { "temp", "5" },
-    { "pointer", "3" }
+// Indexed by ArithOp, acting on *(SP-1) with y in D
+const std::array<std::string_view, 9> memoryArithmetic = {
+    "M=D+M", "M=M-D", "M=-M", "", "", "", "M=M&D", "M=M|D", "M=!M"
 };
 
-CommandMap segments = {
-    { "argument", "ARG" },
-    { "local", "LCL" },
-    { "this", "THIS" },
-    { "that", "THAT" }
+// Indexed by ArithOp, acting on D with x at *(SP-1) for binary operations
+const std::array<std::string_view, 9> cachedArithmetic = {
+    "D=D+M", "D=M-D", "D=-D", "", "", "", "D=D&M", "D=D|M", "D=!D"
 };
 
-CommandMap binaryArithmetic = {
-    { "add", "M=D+M" },
-    { "sub", "M=M-D" },
-    { "and", "M=M&D" },
-    { "or", "M=M|D" }
+// The shared routine for eq, gt and lt, and the jumps taken on y - x when
+// the comparison holds or fails
+struct Comparison {
+    std::string_view routine, jump, negatedJump;
 };
 
-CommandMap unaryArithmetic = {
-    { "neg", "M=-M" },
-    { "not", "M=!M" }
+const std::array<Comparison, 3> comparisons = {{
+    { "EQ", "JEQ", "JNE" },
+    { "GT", "JLT", "JGE" },
+    { "LT", "JGT", "JLE" }
+}};
+
+const Comparison& comparison(ArithOp op)
+{
+    return comparisons[op - OP_EQ];
+};
+
+bool isComparison(ArithOp op)
+{
+    return op == OP_EQ || op == OP_GT || op == OP_LT;
 };
 
-CommandMap comparisons = {
-    { "eq", "EQ" },
-    { "lt", "LT" },
-    { "gt", "GT" }
+// Fixed RAM addresses of the pointer and temp segments
+int segmentBase(Segment segment)
+{
+    return segment == S_POINTER ? 3 : 5;
 };
 
-CodeWriter::CodeWriter(std::ostream& output)
-    : out(output), labelIndex(0), frameIndex(0), callCount(0),
-      currentFilename(""), currentFunction("")
+CodeWriter::CodeWriter(AsmBuffer& output, const CodeWriterOptions& options)
+    : out(output), options(options), labelIndex(0), callCount(0),
+      topInD(false), symbols(nullptr), currentFilename(""), currentFunction("")
 {
-    writeBootstrap();
 };
 
-void CodeWriter::setCurrentFile(const std::string& filename)
+void CodeWriter::setCurrentFile(const std::string& filename, const StringPool& pool)
 {
     currentFilename = filename;
+    symbols = &pool;
+    currentFunction = "";
     callCount = 0;
-    labelIndex = 0;
+};
+
+void CodeWriter::writeCommand(const Command& command)
+{
+    if (!options.fusePatterns) {
+        dispatch(command);
+        return;
+    }
+
+    window.push_back(command);
+    if (window.size() < 4) {
+        return;
+    }
+    if (!writeFused()) {
+        dispatch(window.front());
+        window.pop_front();
+    }
+};
+
+void CodeWriter::flush()
+{
+    while (!window.empty()) {
+        if (!writeFused()) {
+            dispatch(window.front());
+            window.pop_front();
+        }
+    }
+};
+
+void CodeWriter::dispatch(const Command& command)
+{
+    switch(command.type) {
+    case CommandType::C_PUSH:
+    case CommandType::C_POP:
+        writePushPop(command);
+        break;
+    case CommandType::C_ARITHMETIC:
+        writeArithmetic(command);
+        break;
+    case CommandType::C_LABEL:
+        writeLabel(command);
+        break;
+    case CommandType::C_GOTO:
+        writeGoto(command);
+        break;
+    case CommandType::C_IF:
+        writeIf(command);
+        break;
+    case CommandType::C_CALL:
+        writeCall(command);
+        break;
+    case CommandType::C_FUNCTION:
+        writeFunction(command);
+        break;
+    case CommandType::C_RETURN:
+        writeReturn(command);
+        break;
+    }
+};
+
+// Tries each pattern against the front of the window, longest first.
+// The window holds four commands, the length of the longest pattern.
+bool CodeWriter::writeFused()
+{
+    static const std::vector<Pattern> patterns = {
+        // x = x + 1, x = x - 1
+        { { { C_PUSH, ANY, ANY }, { C_PUSH, S_CONSTANT, 1 }, { C_ARITHMETIC, OP_ADD, ANY }, { C_POP, ANY, ANY } },
+          &CodeWriter::fuseIncrement },
+        { { { C_PUSH, ANY, ANY }, { C_PUSH, S_CONSTANT, 1 }, { C_ARITHMETIC, OP_SUB, ANY }, { C_POP, ANY, ANY } },
+          &CodeWriter::fuseIncrement },
+        // a[i] = x
+        { { { C_POP, S_TEMP, ANY }, { C_POP, S_POINTER, 1 }, { C_PUSH, S_TEMP, ANY }, { C_POP, S_THAT, 0 } },
+          &CodeWriter::fuseArrayWrite },
+        // x = a[i]
+        { { { C_ARITHMETIC, OP_ADD, ANY }, { C_POP, S_POINTER, 1 }, { C_PUSH, S_THAT, 0 } },
+          &CodeWriter::fuseArrayRead },
+        // while/if conditions
+        { { { C_ARITHMETIC, ANY, ANY }, { C_ARITHMETIC, OP_NOT, ANY }, { C_IF, ANY, ANY } },
+          &CodeWriter::fuseBranch },
+        { { { C_ARITHMETIC, ANY, ANY }, { C_IF, ANY, ANY } },
+          &CodeWriter::fuseBranch },
+        // x = 0, x = 1
+        { { { C_PUSH, S_CONSTANT, 0 }, { C_POP, ANY, ANY } },
+          &CodeWriter::fuseStoreConstant },
+        { { { C_PUSH, S_CONSTANT, 1 }, { C_POP, ANY, ANY } },
+          &CodeWriter::fuseStoreConstant }
+    };
+
+    for (const auto& pattern : patterns) {
+        if (pattern.steps.size() > window.size()) {
+            continue;
+        }
+
+        bool matches = true;
+        for (std::size_t i = 0; i < pattern.steps.size() && matches; i++) {
+            const auto& step = pattern.steps[i];
+            const auto& command = window[i];
+            int operand = command.type == C_ARITHMETIC ? static_cast<int>(command.op) : command.segment;
+            matches = command.type == step.type
+                && (step.operand == ANY || operand == step.operand)
+                && (step.arg2 == ANY || command.arg2 == step.arg2);
+        }
+
+        if (matches && (this->*pattern.emit)(window)) {
+            window.erase(window.begin(), window.begin() + pattern.steps.size());
+            return true;
+        }
+    }
+
+    return false;
+};
+
+bool CodeWriter::fuseIncrement(const std::deque<Command>& window)
+{
+    const auto& push = window[0];
+    const auto& pop = window[3];
+    if (push.segment == S_CONSTANT || push.segment != pop.segment || push.arg2 != pop.arg2) {
+        return false;
+    }
+
+    spill();
+    loadAddressOf(push.segment, push.arg2);
+    write(window[2].op == OP_ADD ? "M=M+1" : "M=M-1");
+    return true;
+};
+
+bool CodeWriter::fuseStoreConstant(const std::deque<Command>& window)
+{
+    spill();
+    loadAddressOf(window[1].segment, window[1].arg2);
+    write("M=", window[0].arg2);
+    return true;
+};
+
+// THAT is still set, as later code may rely on it
+bool CodeWriter::fuseArrayRead(const std::deque<Command>& window)
+{
+    popToD();
+    loadValue("SP", "A");
+    write("AM=M-1");
+    write("D=D+M");
+    saveValueTo("THAT");
+    write("A=D");
+    write("D=M");
+    pushD();
+    return true;
+};
+
+// The temp slot is still set, as later code may rely on it
+bool CodeWriter::fuseArrayWrite(const std::deque<Command>& window)
+{
+    auto index = window[0].arg2;
+    if (window[2].arg2 != index) {
+        return false;
+    }
+
+    auto temp = segmentBase(S_TEMP) + index;
+    popToD();
+    saveValueTo(temp);
+    popToD();
+    saveValueTo("THAT");
+    loadValue(temp, "A");
+    write("D=M");
+    writeToPointer("THAT", "D");
+    return true;
+};
+
+// Jumps on the comparison itself instead of materialising true or false.
+// y - x is tested, exactly as the comparison routines do.
+bool CodeWriter::fuseBranch(const std::deque<Command>& window)
+{
+    auto op = window[0].op;
+    bool negated = window[1].type == CommandType::C_ARITHMETIC;
+    const auto& target = negated ? window[2] : window[1];
+
+    if (isComparison(op)) {
+        popToD();
+        loadValue("SP", "A");
+        write("AM=M-1");
+        write("D=D-M");
+        write("@", scope(), "$", name(target.symbol));
+        write("D;", negated ? comparison(op).negatedJump : comparison(op).jump);
+        return true;
+    } else if (op == OP_NOT && !negated) {
+        // Jumps unless x is -1. Testing !D in the jump itself saves a
+        // word; D;JEQ would wrongly treat every x other than 0 as true.
+        popToD();
+        write("@", scope(), "$", name(target.symbol));
+        write("!D;JNE");
+        return true;
+    }
+
+    return false;
+};
+
+// Points A at segment[index], which may use D
+void CodeWriter::loadAddressOf(Segment segment, int index)
+{
+    switch (segment) {
+    case S_STATIC:
+        loadValue(staticVariable(index), "A");
+        break;
+    case S_POINTER:
+    case S_TEMP:
+        loadValue(segmentBase(segment) + index, "A");
+        break;
+    default:
+        if (index == 0 || index == 1) {
+            loadValue(segmentPointers[segment], "A");
+            write(index == 0 ? "A=M" : "A=M+1");
+        } else {
+            loadValue(index, "D");
+            loadValue(segmentPointers[segment], "A");
+            write("A=D+M");
+        }
+    }
+};
+
+// Leaves D as the new top of the stack, cached or not
+void CodeWriter::pushD()
+{
+    topInD = true;
+    if (!options.cacheTop) {
+        spill();
+    }
 };
 
 void CodeWriter::writePushPop(const Command& command)
 {
-    auto cmd = command.arg1;
+    if (options.cacheTop && command.type == CommandType::C_PUSH) {
+        pushCached(command);
+        return;
+    } else if (options.cacheTop && command.type == CommandType::C_POP) {
+        popCached(command);
+        return;
+    }
 
     switch(command.type) {
     case CommandType::C_PUSH:
-        if (cmd == "constant") {
+        switch (command.segment) {
+        case S_CONSTANT:
             writeConstant(command.arg2);
-        } else if (cmd == "static") {
-            writeFromAddress(currentFilename + "." + std::to_string(command.arg2), 0);
-        } else if (cmd == "temp" || cmd == "pointer") {
-            writeFromAddress(addresses.find(cmd)->second, command.arg2);
-        } else if (cmd == "argument" || cmd == "local" || cmd == "this" || cmd == "that") {
-            writeFromSegment(segments.find(cmd)->second, command.arg2);
+            break;
+        case S_STATIC:
+            writeFromAddress(staticVariable(command.arg2), 0);
+            break;
+        case S_POINTER:
+        case S_TEMP:
+            writeFromAddress(number(segmentBase(command.segment)), command.arg2);
+            break;
+        default:
+            writeFromSegment(segmentPointers[command.segment], command.arg2);
         }
 
         incrementPointer("SP");
@@ -68,12 +314,16 @@ void CodeWriter::writePushPop(const Command& command)
     case CommandType::C_POP:
         pop("A");
 
-        if (cmd == "static") {
-            writeToAddress(currentFilename + "." + std::to_string(command.arg2), 0);
-        } else if (cmd == "temp" || cmd == "pointer") {
-            writeToAddress(addresses.find(cmd)->second, command.arg2);
-        } else if (cmd == "argument" || cmd == "local" || cmd == "this" || cmd == "that") {
-            writeToSegment(segments.find(cmd)->second, command.arg2);
+        switch (command.segment) {
+        case S_STATIC:
+            writeToAddress(staticVariable(command.arg2), 0);
+            break;
+        case S_POINTER:
+        case S_TEMP:
+            writeToAddress(number(segmentBase(command.segment)), command.arg2);
+            break;
+        default:
+            writeToSegment(segmentPointers[command.segment], command.arg2);
         }
 
         break;
@@ -85,48 +335,74 @@ void CodeWriter::writePushPop(const Command& command)
 
 void CodeWriter::writeArithmetic(const Command& command)
 {
-    pop("D");
+    if (isComparison(command.op)) {
+        compare(command.op);
+        return;
+    } else if (options.cacheTop) {
+        arithmeticCached(command);
+        return;
+    }
 
-    auto cmd = command.arg1;
-    if (cmd == "neg" || cmd == "not") {
-        write(unaryArithmetic.find(cmd)->second);
-    } else {
+    pop("D");
+    if (command.op != OP_NEG && command.op != OP_NOT) {
         pop("A");
-        if (cmd == "add" || cmd == "sub" || cmd == "and" || cmd == "or") {
-            write(binaryArithmetic.find(cmd)->second);
-        } else if (cmd == "eq" || cmd == "gt" || cmd == "lt") {
-            compare(comparisons.find(cmd)->second);
-        }
     }
+    write(memoryArithmetic[command.op]);
 
     incrementPointer("SP");
 };
 
 void CodeWriter::writeLabel(const Command& command)
 {
-    write("(" + currentFunction + "$" + command.arg1 + ")");
+    spill();
+    write("(", scope(), "$", name(command.symbol), ")");
 };
 
 void CodeWriter::writeGoto(const Command& command)
 {
-
-    write("@" + currentFunction + "$" + command.arg1);
+    spill();
+    write("@", scope(), "$", name(command.symbol));
     write("0;JEQ");
 };
 
 void CodeWriter::writeIf(const Command& command)
 {
-    pop("D");
-    write("@" + currentFunction + "$" + command.arg1);
+    if (options.cacheTop) {
+        popToD();
+    } else {
+        pop("D");
+    }
+    write("@", scope(), "$", name(command.symbol));
     write("D;JNE");
 };
 
 void CodeWriter::writeCall(const Command& command)
 {
-    auto returnAddr = currentFilename + "." + command.arg1 + ".RET." + std::to_string(callCount++);
+    call(name(command.symbol), command.arg2);
+};
+
+void CodeWriter::call(std::string_view function, int nArgs)
+{
+    auto returnIndex = callCount++;
+    spill();
+
+    if (options.sharedCalls) {
+        // R13 = f, R14 = n, D = return-address
+        loadValue(function, "D");
+        saveValueTo("R13");
+        loadValue(nArgs, "D");
+        saveValueTo("R14");
+        write("@", currentFilename, ".", function, ".RET.", returnIndex);
+        write("D=A");
+        write("@$$CALL");
+        write("0;JMP");
+        write("(", currentFilename, ".", function, ".RET.", returnIndex, ")");
+        return;
+    }
 
     // push return-address
-    loadValue(returnAddr, "D");
+    write("@", currentFilename, ".", function, ".RET.", returnIndex);
+    write("D=A");
     writeToPointer("SP", "D");
     incrementPointer("SP");
 
@@ -151,7 +427,7 @@ void CodeWriter::writeCall(const Command& command)
     incrementPointer("SP");
 
     // ARG = SP - n - 5
-    loadValue(std::to_string(command.arg2), "D");
+    loadValue(nArgs, "D");
     loadValue("5", "A");
     write("D=D+A");
     loadValue("SP", "A");
@@ -163,17 +439,18 @@ void CodeWriter::writeCall(const Command& command)
     saveValueTo("LCL");
 
     // goto f
-    write("@" + command.arg1);
+    write("@", function);
     write("0;JEQ");
 
     // (return-address)
-    write("(" + returnAddr + ")");
+    write("(", currentFilename, ".", function, ".RET.", returnIndex, ")");
 };
 
 void CodeWriter::writeFunction(const Command& command)
 {
-    currentFunction = command.arg1;
-    write("(" + currentFunction + ")");
+    spill();
+    currentFunction = name(command.symbol);
+    write("(", currentFunction, ")");
     for (std::size_t i = 0; i < command.arg2; i++) {
         writeToPointer("SP", "0");
         incrementPointer("SP");
@@ -182,65 +459,117 @@ void CodeWriter::writeFunction(const Command& command)
 
 void CodeWriter::writeReturn(const Command& command)
 {
-    // // FRAME = LCL
-    auto frame = currentFunction + ".frame." + std::to_string(frameIndex++);
-    auto returnLabel = frame + ".RET";
-    loadFromAddress("LCL", "D");
-    saveValueTo(frame);
+    spill();
+    if (options.sharedCalls) {
+        write("@$$RETURN");
+        write("0;JMP");
+        return;
+    }
 
-    // RET = *(FRAME-5)
-    loadValue("5", "D");
-    loadValue(frame, "A");
-    write("A=M-D");
-    write("D=M");
-    saveValueTo(returnLabel);
+    restoreFrame();
+};
 
-    // *ARG = pop()
-    pop("D");
-    writeToPointer("ARG", "D");
+const StaticUsage& CodeWriter::staticUsage() const noexcept
+{
+    return statics;
+};
 
-    // SP = ARG + 1
-    loadFromAddress("ARG", "D");
-    loadValue("SP", "A");
-    write("M=D+1");
+// With cacheTop set, topInD says whether the top of the stack is held in D
+// rather than at *(SP-1). SP always counts only the values in memory.
+void CodeWriter::pushCached(const Command& command)
+{
+    auto index = command.arg2;
+    spill();
+
+    if (command.segment == S_CONSTANT) {
+        if (index == 0 || index == 1) {
+            write("D=", index);
+        } else {
+            loadValue(index, "D");
+        }
+    } else {
+        loadAddressOf(command.segment, index);
+        write("D=M");
+    }
 
-    // THAT = *(FRAME-1)
-    loadValue("1", "D");
-    loadValue(frame, "A");
-    write("A=M-D");
-    write("D=M");
-    saveValueTo("THAT");
+    topInD = true;
+};
 
-    // THIS = *(FRAME-2)
-    loadValue("2", "D");
-    loadValue(frame, "A");
-    write("A=M-D");
-    write("D=M");
-    saveValueTo("THIS");
+void CodeWriter::popCached(const Command& command)
+{
+    auto index = command.arg2;
+    popToD();
 
-    // ARG = *(FRAME-3)
-    loadValue("3", "D");
-    loadValue(frame, "A");
-    write("A=M-D");
-    write("D=M");
-    saveValueTo("ARG");
+    switch (command.segment) {
+    case S_STATIC:
+        saveValueTo(staticVariable(index));
+        break;
+    case S_POINTER:
+    case S_TEMP:
+        saveValueTo(segmentBase(command.segment) + index);
+        break;
+    default:
+        if (index < 8) {
+            // Walking A up to the address is shorter than going through R13/R14
+            loadFromPointer(segmentPointers[command.segment], "A");
+            for (int i = 0; i < index; i++) {
+                write("A=A+1");
+            }
+            write("M=D");
+        } else {
+            saveValueTo("R13");
+            loadValue(index, "D");
+            loadValue(segmentPointers[command.segment], "A");
+            write("D=D+M");
+            saveValueTo("R14");
+            loadFromAddress("R13", "D");
+            writeToPointer("R14", "D");
+        }
+    }
+};
 
-    // LCL = *(FRAME-4)
-    loadValue("4", "D");
-    loadValue(frame, "A");
-    write("A=M-D");
-    write("D=M");
-    saveValueTo("LCL");
+void CodeWriter::arithmeticCached(const Command& command)
+{
+    popToD();
+    if (command.op != OP_NEG && command.op != OP_NOT) {
+        // D holds y, x is left at *(SP-1)
+        loadValue("SP", "A");
+        write("AM=M-1");
+    }
+    write(cachedArithmetic[command.op]);
+    topInD = true;
+};
 
-    loadFromAddress(returnLabel, "A");
-    write("0;JEQ");
+// Writes a cached top of the stack back to memory
+void CodeWriter::spill()
+{
+    if (!topInD) {
+        return;
+    }
+    loadValue("SP", "A");
+    write("AM=M+1");
+    write("A=A-1");
+    write("M=D");
+    topInD = false;
+};
+
+// Moves the top of the stack into D, removing it from the stack
+void CodeWriter::popToD()
+{
+    if (topInD) {
+        topInD = false;
+        return;
+    }
+    loadValue("SP", "A");
+    write("AM=M-1");
+    write("D=M");
 };
 
 // TODO: rationalise helper methods:
 // loadValue, loadVariable, loadPointer
 // writeValue, writeVariable, writePointer
 
-void CodeWriter::pop(const std::string& dest)
+void CodeWriter::pop(std::string_view dest)
 {
     decrementPointer("SP");
     loadFromPointer("SP", "A");
@@ -251,31 +580,31 @@ void CodeWriter::pop(const std::string& dest)
 
 void CodeWriter::writeConstant(int value)
 {
-    loadValue(std::to_string(value), "D");
+    loadValue(value, "D");
     writeToPointer("SP", "D");
 };
 
-void CodeWriter::writeFromSegment(const std::string& segment, int index)
+void CodeWriter::writeFromSegment(std::string_view segment, int index)
 {
-    loadValue(std::to_string(index), "D");
+    loadValue(index, "D");
     loadFromPointer(segment, "A");
     write("A=A+D");
     write("D=M");
     writeToPointer("SP", "D");
 };
 
-void CodeWriter::writeFromAddress(const std::string& address, int index)
+void CodeWriter::writeFromAddress(std::string_view address, int index)
 {
-    loadValue(std::to_string(index), "D");
+    loadValue(index, "D");
     loadValue(address, "A");
     write("A=A+D");
     write("D=M");
     writeToPointer("SP", "D");
 };
 
-void CodeWriter::writeToSegment(const std::string& segment, int index)
+void CodeWriter::writeToSegment(std::string_view segment, int index)
 {
-    loadValue(std::to_string(index), "D");
+    loadValue(index, "D");
     loadFromPointer(segment, "A");
     write("D=A+D");
     saveValueTo("R13");
@@ -283,9 +612,9 @@ void CodeWriter::writeToSegment(const std::string& segment, int index)
     writeToPointer("R13", "D");
 };
 
-void CodeWriter::writeToAddress(const std::string& address, int index)
+void CodeWriter::writeToAddress(std::string_view address, int index)
 {
-    loadValue(std::to_string(index), "D");
+    loadValue(index, "D");
     loadValue(address, "A");
     write("D=A+D");
     saveValueTo("R13");
@@ -293,25 +622,25 @@ void CodeWriter::writeToAddress(const std::string& address, int index)
     writeToPointer("R13", "D");
 };
 
-void CodeWriter::incrementPointer(const std::string& address)
+void CodeWriter::incrementPointer(std::string_view address)
 {
     loadValue(address, "A");
     write("M=M+1");
 };
 
-void CodeWriter::decrementPointer(const std::string& address)
+void CodeWriter::decrementPointer(std::string_view address)
 {
     loadValue(address, "A");
     write("M=M-1");
 };
 
-void CodeWriter::writeToPointer(const std::string& address, const std::string& val)
+void CodeWriter::writeToPointer(std::string_view address, std::string_view val)
 {
     loadFromPointer(address, "A");
-    write("M=" + val);
+    write("M=", val);
 };
 
-void CodeWriter::loadFromPointer(const std::string& address, const std::string& dest)
+void CodeWriter::loadFromPointer(std::string_view address, std::string_view dest)
 {
     loadValue(address, "A");
     write("A=M");
@@ -320,74 +649,218 @@ void CodeWriter::loadFromPointer(const std::string& address, const std::string&
     }
 };
 
-void CodeWriter::loadFromAddress(const std::string& address, const std::string& dest)
+void CodeWriter::loadFromAddress(std::string_view address, std::string_view dest)
 {
     loadValue(address, "A");
-    write(dest + "=M");
+    write(dest, "=M");
 };
 
-void CodeWriter::loadValue(const std::string& value, const std::string& dest)
+void CodeWriter::loadValue(std::string_view value, std::string_view dest)
 {
-    write("@" + value);
+    write("@", value);
     if (dest == "D") {
         write("D=A");
     }
 };
 
-void CodeWriter::saveValueTo(const std::string& address)
+void CodeWriter::loadValue(int value, std::string_view dest)
+{
+    write("@", value);
+    if (dest == "D") {
+        write("D=A");
+    }
+};
+
+void CodeWriter::saveValueTo(std::string_view address)
 {
     loadValue(address, "A");
     write("M=D");
 };
 
-void CodeWriter::compare(const std::string& comparison)
+void CodeWriter::saveValueTo(int address)
 {
-    std::string labelName = "JUMPPOINT" + std::to_string(labelIndex++);
-    write("D=D-M");
-    saveValueTo("R13");
-    loadValue(labelName, "D");
-    saveValueTo("R14");
-    write("@" + comparison);
-    write("0;JMP");
-    write("(" + labelName + ")");
+    loadValue(address, "A");
+    write("M=D");
 };
 
-void CodeWriter::write(const std::string& arg)
+// Replaces x and y on the stack with the result of the comparison, either
+// inline or through the shared EQ/LT/GT routines
+void CodeWriter::compare(ArithOp op)
 {
-    out << arg << std::endl;
+    auto labelIndex = this->labelIndex++;
+
+    if (options.inlineCompare) {
+        auto endIndex = this->labelIndex++;
+        popToD();
+        loadValue("SP", "A");
+        write("AM=M-1");
+        write("D=D-M");
+        write("@", scope(), "$JUMPPOINT", labelIndex);
+        write("D;", comparison(op).jump);
+        write("D=0");
+        write("@", scope(), "$JUMPPOINT", endIndex);
+        write("0;JMP");
+        write("(", scope(), "$JUMPPOINT", labelIndex, ")");
+        write("D=-1");
+        write("(", scope(), "$JUMPPOINT", endIndex, ")");
+        pushD();
+        return;
+    }
+
+    // The routines take the return address in D and work on the stack
+    spill();
+    write("@", scope(), "$JUMPPOINT", labelIndex);
+    write("D=A");
+    write("@", comparison(op).routine);
+    write("0;JMP");
+    write("(", scope(), "$JUMPPOINT", labelIndex, ")");
 };
 
 void CodeWriter::writeBootstrap()
 {
-    Command initCommand{ .type = C_CALL, .arg1 = "Sys.init", .arg2 = 0 };
-
     write("@START");
     write("0;JEQ");
-    equalityFn("(EQ)", "D;JEQ");
-    equalityFn("(LT)", "D;JGT");
-    equalityFn("(GT)", "D;JLT");
-    write("(END)");
-    loadFromPointer("R14", "A");
-    write("0;JEQ");
+    if (!options.inlineCompare) {
+        for (const auto& routine : comparisons) {
+            equalityFn(routine.routine, routine.jump);
+        }
+        write("(END)");
+        loadFromPointer("R14", "A");
+        write("0;JEQ");
+    }
+    if (options.sharedCalls) {
+        callFn();
+        returnFn();
+    }
     write("(START)");
     loadValue("256", "D");
     saveValueTo("SP");
-    writeCall(initCommand);
+    call("Sys.init", 0);
 };
 
-void CodeWriter::equalityFn(const std::string& label, const std::string& comparison)
+// Saves the return address from D in R14, pops y and overwrites x
+void CodeWriter::equalityFn(std::string_view name, std::string_view jump)
 {
-    write(label);
-    write("@R13");
+    write("(", name, ")");
+    saveValueTo("R14");
+    loadValue("SP", "A");
+    write("AM=M-1");
     write("D=M");
-    write("@TRUE");
-    write(comparison);
-    write("@FALSE");
+    write("A=A-1");
+    write("D=D-M");
+    write("@", name, "_TRUE");
+    write("D;", jump);
+    loadValue("SP", "A");
+    write("A=M-1");
+    write("M=0");
+    write("@END");
     write("0;JEQ");
-    write("(TRUE)");
-    writeToPointer("SP", "-1");
+    write("(", name, "_TRUE)");
+    loadValue("SP", "A");
+    write("A=M-1");
+    write("M=-1");
     write("@END");
     write("0;JEQ");
-    write("(FALSE)");
-    writeToPointer("SP", "0");
+};
+
+// Expects the return address in D, the function in R13 and nArgs in R14
+void CodeWriter::callFn()
+{
+    write("($$CALL)");
+    writeToPointer("SP", "D");
+    incrementPointer("SP");
+
+    for (auto segment : { "LCL", "ARG", "THIS", "THAT" }) {
+        loadFromAddress(segment, "D");
+        writeToPointer("SP", "D");
+        incrementPointer("SP");
+    }
+
+    // ARG = SP - n - 5
+    loadFromAddress("R14", "D");
+    loadValue("5", "A");
+    write("D=D+A");
+    loadValue("SP", "A");
+    write("D=M-D");
+    saveValueTo("ARG");
+
+    // LCL = SP
+    loadFromAddress("SP", "D");
+    saveValueTo("LCL");
+
+    loadFromPointer("R13", "A");
+    write("0;JMP");
+};
+
+void CodeWriter::returnFn()
+{
+    write("($$RETURN)");
+    restoreFrame();
+};
+
+// Keeps FRAME in R13 and the return address in R14 rather than in
+// variables, which would each take a word of static memory
+void CodeWriter::restoreFrame()
+{
+    // FRAME = LCL
+    loadFromAddress("LCL", "D");
+    saveValueTo("R13");
+
+    // RET = *(FRAME-5)
+    loadValue("5", "A");
+    write("A=D-A");
+    write("D=M");
+    saveValueTo("R14");
+
+    // *ARG = pop()
+    pop("D");
+    writeToPointer("ARG", "D");
+
+    // SP = ARG + 1
+    loadFromAddress("ARG", "D");
+    loadValue("SP", "A");
+    write("M=D+1");
+
+    // THAT, THIS, ARG, LCL = *(FRAME-1) ... *(FRAME-4)
+    for (auto segment : { "THAT", "THIS", "ARG", "LCL" }) {
+        loadValue("R13", "A");
+        write("AM=M-1");
+        write("D=M");
+        saveValueTo(segment);
+    }
+
+    loadFromPointer("R14", "A");
+    write("0;JMP");
+};
+
+// Labels belong to the current function, or to the file outside of one,
+// so every file can be translated on its own
+std::string_view CodeWriter::scope() const
+{
+    return currentFunction.empty() ? currentFilename : currentFunction;
+};
+
+std::string_view CodeWriter::name(SymbolId id) const
+{
+    return symbols->name(id);
+};
+
+// Builds the name in a reused buffer, valid until the next call
+std::string_view CodeWriter::staticVariable(int index)
+{
+    auto usage = statics.find(currentFilename);
+    if (usage == statics.end()) {
+        usage = statics.emplace(currentFilename, std::set<int>{}).first;
+    }
+    usage->second.insert(index);
+
+    staticName.assign(currentFilename).append(".").append(number(index));
+    return staticName;
+};
+
+// Formats value in a reused buffer, valid until the next call
+std::string_view CodeWriter::number(int value)
+{
+    auto result = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+    return { digits.data(), static_cast<std::size_t>(result.ptr - digits.data()) };
 };
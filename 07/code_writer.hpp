@@ -1,14 +1,38 @@
 #ifndef __code_writer__
 #define __code_writer__
 
+#include <array>
+#include <deque>
 #include <iostream>
+#include <map>
+#include <set>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "asm_buffer.hpp"
 #include "parser.hpp"
 
+// Static variable indices used by each file
+typedef std::map<std::string, std::set<int>> StaticUsage;
+
+struct CodeWriterOptions {
+    // Jump to shared $$CALL/$$RETURN routines instead of inlining the frame code
+    bool sharedCalls;
+    // Keep the top of the stack in D within basic blocks
+    bool cacheTop;
+    // Emit specialised code for common multi-command sequences
+    bool fusePatterns;
+    // Compare inline instead of calling the shared EQ/LT/GT routines
+    bool inlineCompare;
+};
+
 class CodeWriter {
 public:
-    CodeWriter(std::ostream& output);
-    void setCurrentFile(const std::string& filename);
+    CodeWriter(AsmBuffer& output, const CodeWriterOptions& options);
+    void writeBootstrap();
+    void setCurrentFile(const std::string& filename, const StringPool& pool);
+    void writeCommand(const Command& command);
+    void flush();
     void writePushPop(const Command& command);
     void writeArithmetic(const Command& command);
     void writeLabel(const Command& command);
@@ -17,27 +41,75 @@ public:
     void writeCall(const Command& command);
     void writeFunction(const Command& command);
     void writeReturn(const Command& command);
+    const StaticUsage& staticUsage() const noexcept;
 private:
-    void pop(const std::string& dest);
+    // One command of a fusion pattern. operand is the segment or the
+    // arithmetic op, and ANY matches every operand or arg2.
+    static constexpr int ANY = -1;
+    struct PatternStep {
+        CommandType type;
+        int operand;
+        int arg2;
+    };
+    // Emitters may still decline a match by returning false before writing anything
+    struct Pattern {
+        std::vector<PatternStep> steps;
+        bool (CodeWriter::*emit)(const std::deque<Command>& window);
+    };
+    void dispatch(const Command& command);
+    bool writeFused();
+    bool fuseIncrement(const std::deque<Command>& window);
+    bool fuseStoreConstant(const std::deque<Command>& window);
+    bool fuseArrayRead(const std::deque<Command>& window);
+    bool fuseArrayWrite(const std::deque<Command>& window);
+    bool fuseBranch(const std::deque<Command>& window);
+    void loadAddressOf(Segment segment, int index);
+    void pushD();
+    void pop(std::string_view dest);
     void writeConstant(int value);
-    void writeFromSegment(const std::string& segment, int index);
-    void writeFromAddress(const std::string& address, int index);
-    void writeToSegment(const std::string& segment, int index);
-    void writeToAddress(const std::string& address, int index);
-    void incrementPointer(const std::string& address);
-    void decrementPointer(const std::string& address);
-    void writeToPointer(const std::string& address, const std::string& val);
-    void loadFromPointer(const std::string& address, const std::string& dest);
-    void loadFromAddress(const std::string& address, const std::string& dest);
-    void loadValue(const std::string& value, const std::string& dest);
-    void saveValueTo(const std::string& address);
-    void compare(const std::string& comparison);
-    void write(const std::string& arg);
-    void writeBootstrap();
-    void equalityFn(const std::string& label, const std::string& comparison);
-    std::ostream& out;
-    int labelIndex, frameIndex, callCount;
+    void writeFromSegment(std::string_view segment, int index);
+    void writeFromAddress(std::string_view address, int index);
+    void writeToSegment(std::string_view segment, int index);
+    void writeToAddress(std::string_view address, int index);
+    void incrementPointer(std::string_view address);
+    void decrementPointer(std::string_view address);
+    void writeToPointer(std::string_view address, std::string_view val);
+    void loadFromPointer(std::string_view address, std::string_view dest);
+    void loadFromAddress(std::string_view address, std::string_view dest);
+    void loadValue(std::string_view value, std::string_view dest);
+    void loadValue(int value, std::string_view dest);
+    void saveValueTo(std::string_view address);
+    void saveValueTo(int address);
+    void compare(ArithOp op);
+    template<typename... Parts>
+    void write(const Parts&... parts)
+    {
+        out.line(parts...);
+    };
+    void equalityFn(std::string_view name, std::string_view jump);
+    void call(std::string_view function, int nArgs);
+    void callFn();
+    void returnFn();
+    void restoreFrame();
+    void pushCached(const Command& command);
+    void popCached(const Command& command);
+    void arithmeticCached(const Command& command);
+    void spill();
+    void popToD();
+    std::string_view name(SymbolId id) const;
+    std::string_view scope() const;
+    std::string_view staticVariable(int index);
+    std::string_view number(int value);
+    AsmBuffer& out;
+    CodeWriterOptions options;
+    int labelIndex, callCount;
+    bool topInD;
+    const StringPool* symbols;
     std::string currentFilename, currentFunction;
+    StaticUsage statics;
+    std::string staticName;
+    std::array<char, 12> digits;
+    std::deque<Command> window;
 };
 
 #endif
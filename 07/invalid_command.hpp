@@ -0,0 +1,17 @@
+#ifndef __invalid_command__
+#define __invalid_command__
+
+#include <exception>
+#include <string>
+
+class InvalidCommand : public std::exception
+{
+ public:
+    InvalidCommand(std::string command) : command(command) {}
+    ~InvalidCommand() noexcept {}
+    virtual const char* what() const noexcept { return command.c_str(); }
+private:
+    std::string command;
+};
+
+#endif
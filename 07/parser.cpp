@@ -1,91 +1,187 @@
-#include <string>
-#include <vector>
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <iterator>
-#include <map>
+#include <algorithm>
+#include <charconv>
 #include "parser.hpp"
 
-typedef std::map<std::string, CommandType> CommandMap;
-
-CommandMap commands = {
-                       { "add", CommandType::C_ARITHMETIC },
-                       { "sub", CommandType::C_ARITHMETIC },
-                       { "neg", CommandType::C_ARITHMETIC },
-                       { "eq", CommandType::C_ARITHMETIC },
-                       { "gt", CommandType::C_ARITHMETIC },
-                       { "lt", CommandType::C_ARITHMETIC },
-                       { "and", CommandType::C_ARITHMETIC },
-                       { "or", CommandType::C_ARITHMETIC },
-                       { "not", CommandType::C_ARITHMETIC },
-                       { "push", CommandType::C_PUSH },
-                       { "pop", CommandType::C_POP },
-                       { "label", CommandType::C_LABEL },
-                       { "goto", CommandType::C_GOTO },
-                       { "if-goto", CommandType::C_IF },
-                       { "function", CommandType::C_FUNCTION },
-                       { "return", CommandType::C_RETURN },
-                       { "call", CommandType::C_CALL }
+namespace {
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
 };
 
-Parser::Parser(std::istream& input) : source(input) { };
+// Strips the comment and surrounding whitespace from a line
+std::string_view sanitise(std::string_view line)
+{
+    auto commentPos = line.find("//");
+    if (commentPos != std::string_view::npos) {
+        line.remove_suffix(line.size() - commentPos);
+    }
+    while (!line.empty() && isSpace(line.front())) {
+        line.remove_prefix(1);
+    }
+    while (!line.empty() && isSpace(line.back())) {
+        line.remove_suffix(1);
+    }
+    return line;
+};
+
+// Takes the next whitespace separated field off the front of line
+std::string_view nextField(std::string_view& line)
+{
+    while (!line.empty() && isSpace(line.front())) {
+        line.remove_prefix(1);
+    }
+    std::size_t length = 0;
+    while (length < line.size() && !isSpace(line[length])) {
+        length++;
+    }
+    auto field = line.substr(0, length);
+    line.remove_prefix(length);
+    return field;
+};
+
+// Every VM opcode and segment name is at most eight bytes ("function",
+// "argument", "constant"), so each fits in one uint64_t key. Longer
+// words map to a key no case label uses.
+constexpr uint64_t pack(std::string_view name)
+{
+    if (name.size() > 8) {
+        return UINT64_MAX;
+    }
+
+    uint64_t key = 0;
+    for (auto c : name) {
+        key = (key << 8) | static_cast<unsigned char>(c);
+    }
+    return key;
+};
+
+bool commandType(std::string_view op, Command& command)
+{
+    switch (pack(op)) {
+    case pack("add"): command.op = OP_ADD; break;
+    case pack("sub"): command.op = OP_SUB; break;
+    case pack("neg"): command.op = OP_NEG; break;
+    case pack("eq"):  command.op = OP_EQ;  break;
+    case pack("gt"):  command.op = OP_GT;  break;
+    case pack("lt"):  command.op = OP_LT;  break;
+    case pack("and"): command.op = OP_AND; break;
+    case pack("or"):  command.op = OP_OR;  break;
+    case pack("not"): command.op = OP_NOT; break;
+    case pack("push"):     command.type = C_PUSH;     return true;
+    case pack("pop"):      command.type = C_POP;      return true;
+    case pack("label"):    command.type = C_LABEL;    return true;
+    case pack("goto"):     command.type = C_GOTO;     return true;
+    case pack("if-goto"):  command.type = C_IF;       return true;
+    case pack("function"): command.type = C_FUNCTION; return true;
+    case pack("return"):   command.type = C_RETURN;   return true;
+    case pack("call"):     command.type = C_CALL;     return true;
+    default:
+        return false;
+    }
+
+    command.type = C_ARITHMETIC;
+    return true;
+};
+
+bool segment(std::string_view name, Segment& segment)
+{
+    switch (pack(name)) {
+    case pack("argument"): segment = S_ARGUMENT; return true;
+    case pack("local"):    segment = S_LOCAL;    return true;
+    case pack("this"):     segment = S_THIS;     return true;
+    case pack("that"):     segment = S_THAT;     return true;
+    case pack("static"):   segment = S_STATIC;   return true;
+    case pack("constant"): segment = S_CONSTANT; return true;
+    case pack("pointer"):  segment = S_POINTER;  return true;
+    case pack("temp"):     segment = S_TEMP;     return true;
+    }
+    return false;
+};
+
+}
+
+Parser::Parser(std::string_view source, StringPool& symbols)
+    : source(source), currentCommand(), symbols(symbols) { };
 
 bool Parser::hasMoreCommands() noexcept
 {
-    return source.peek() != EOF;
+    skipBlankLines();
+    return !source.empty();
 };
 
 void Parser::advance()
 {
-    std::string input;
-    std::getline(source, input);
-    currentCommand = sanitise(input);
+    skipBlankLines();
 
-    // Skip empty lines
-    if (currentCommand.empty()) {
-        advance();
+    auto end = source.find('\n');
+    if (end == std::string_view::npos) {
+        end = source.size();
     }
+    currentCommand = sanitise(source.substr(0, end));
+    source.remove_prefix(std::min(end + 1, source.size()));
 };
 
 Command Parser::parse()
 {
-    std::stringstream ss{currentCommand};
-    std::istream_iterator<std::string> begin{ss};
-    std::istream_iterator<std::string> end;
-    std::vector<std::string> elems(begin, end);
+    auto rest = currentCommand;
+    auto op = nextField(rest);
+    Command command{};
 
-    auto commandType = commands[elems[0]];
-    Command command{ .type = commandType };
+    if (!commandType(op, command)) {
+        throw InvalidCommand{std::string(currentCommand)};
+    }
 
-    switch (commandType) {
+    switch (command.type) {
     case CommandType::C_ARITHMETIC:
     case CommandType::C_RETURN:
-        command.arg1 = elems[0];
         break;
     case CommandType::C_PUSH:
     case CommandType::C_POP:
     case CommandType::C_CALL:
-    case CommandType::C_FUNCTION:
-        command.arg1 = elems[1];
-        command.arg2 = std::stoi(elems[2]);
+    case CommandType::C_FUNCTION: {
+        auto name = nextField(rest);
+        auto number = nextField(rest);
+        auto result = std::from_chars(number.data(), number.data() + number.size(), command.arg2);
+        if (name.empty() || number.empty() || result.ec != std::errc() || result.ptr != number.data() + number.size()) {
+            throw InvalidCommand{std::string(currentCommand)};
+        }
+        if (command.type == C_CALL || command.type == C_FUNCTION) {
+            command.symbol = symbols.intern(name);
+        } else if (!segment(name, command.segment) || (command.type == C_POP && command.segment == S_CONSTANT)) {
+            throw InvalidCommand{std::string(currentCommand)};
+        }
         break;
+    }
     case CommandType::C_LABEL:
     case CommandType::C_GOTO:
-    case CommandType::C_IF:
-        command.arg1 = elems[1];
+    case CommandType::C_IF: {
+        auto name = nextField(rest);
+        if (name.empty()) {
+            throw InvalidCommand{std::string(currentCommand)};
+        }
+        command.symbol = symbols.intern(name);
         break;
     }
+    }
 
+    if (!nextField(rest).empty()) {
+        throw InvalidCommand{std::string(currentCommand)};
+    }
     return command;
 };
 
-// TODO - not handling comments and empty lines correctly
-std::string Parser::sanitise(std::string s)
+// Comment-only and empty lines carry no command
+void Parser::skipBlankLines() noexcept
 {
-    auto commentPos = s.find("//");
-    if (commentPos != std::string::npos) {
-        s.erase(commentPos);
+    while (!source.empty()) {
+        auto end = source.find('\n');
+        if (end == std::string_view::npos) {
+            end = source.size();
+        }
+        if (!sanitise(source.substr(0, end)).empty()) {
+            return;
+        }
+        source.remove_prefix(std::min(end + 1, source.size()));
     }
-    return s;
 };
@@ -1,9 +1,14 @@
 #ifndef __parser__
 #define __parser__
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "string_pool.hpp"
+#include "invalid_command.hpp"
 
-enum CommandType {
+enum CommandType : uint8_t {
                   C_ARITHMETIC,
                   C_PUSH,
                   C_POP,
@@ -15,23 +20,62 @@ enum CommandType {
                   C_CALL
 };
 
+enum Segment : uint8_t {
+                  S_ARGUMENT,
+                  S_LOCAL,
+                  S_THIS,
+                  S_THAT,
+                  S_STATIC,
+                  S_CONSTANT,
+                  S_POINTER,
+                  S_TEMP
+};
+
+enum ArithOp : uint8_t {
+                  OP_ADD,
+                  OP_SUB,
+                  OP_NEG,
+                  OP_EQ,
+                  OP_GT,
+                  OP_LT,
+                  OP_AND,
+                  OP_OR,
+                  OP_NOT
+};
+
+// push and pop use segment and arg2, arithmetic uses op. label, goto,
+// if-goto, function and call name symbol in the file's pool, with
+// nLocals or nArgs in arg2.
 struct Command {
     CommandType type;
-    std::string arg1;
+    Segment segment;
+    ArithOp op;
+    SymbolId symbol;
     int arg2;
 };
 
+// The commands of one .vm file, named after its stem. The pool refers
+// into source, which is kept alongside it.
+struct VmFile {
+    std::string name;
+    std::vector<char> source;
+    StringPool symbols;
+    std::vector<Command> commands;
+};
+
+// Splits lines of source into fields in place, without copying them
 class Parser {
 public:
-    Parser(std::istream&);
+    Parser(std::string_view source, StringPool& symbols);
     ~Parser() = default;
     bool hasMoreCommands() noexcept;
     void advance();
     Command parse();
 private:
-    std::istream& source;
-    std::string currentCommand;
-    std::string sanitise(std::string);
+    std::string_view source;
+    std::string_view currentCommand;
+    StringPool& symbols;
+    void skipBlankLines() noexcept;
 };
 
 #endif
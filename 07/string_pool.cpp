@@ -0,0 +1,15 @@
+#include "string_pool.hpp"
+
+SymbolId StringPool::intern(std::string_view name)
+{
+    auto [entry, inserted] = ids.emplace(name, names.size());
+    if (inserted) {
+        names.push_back(name);
+    }
+    return entry->second;
+};
+
+std::string_view StringPool::name(SymbolId id) const noexcept
+{
+    return names[id];
+};
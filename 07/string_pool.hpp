@@ -0,0 +1,22 @@
+#ifndef __string_pool__
+#define __string_pool__
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+typedef uint32_t SymbolId;
+
+// Interns names as small ids. Names are not copied, so they must outlive
+// the pool: the parser interns views into the source it was given.
+class StringPool {
+public:
+    SymbolId intern(std::string_view name);
+    std::string_view name(SymbolId id) const noexcept;
+private:
+    std::unordered_map<std::string_view, SymbolId> ids;
+    std::vector<std::string_view> names;
+};
+
+#endif
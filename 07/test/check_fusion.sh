@@ -0,0 +1,82 @@
+#!/bin/bash
+# Checks that --fuse does not change what a program does. Each 11/test
+# program is compiled along with the 12 OS, translated with and without
+# --fuse under each set of flags below, and run in hack_emulator.
+#
+# Programs that halt must finish with the same statics, heap and screen,
+# having called the same functions with the same SP. Programs still
+# waiting for input at the cycle limit must agree on every call made by
+# the run that got less far.
+#
+# Expects 07/vm, 07/hack_emulator and 11/JackAnalyzer to be built;
+# make check in 07 builds them first. CYCLES sets the cycle limit.
+
+set -e
+
+here=$(cd "$(dirname "$0")" && pwd)
+repo=$(dirname "$(dirname "$here")")
+vm=$repo/07/vm
+emulator=$repo/07/hack_emulator
+compiler=$repo/11/JackAnalyzer
+cycles=${CYCLES:-20000000}
+
+flagSets=("" "--cache-stack-top" "--shared-calls --cache-stack-top --inline-compare")
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# Counts the instructions in an .asm file
+romWords() {
+    grep -cv '^\s*\((\|//\|$\)' "$1"
+}
+
+failed=0
+for program in "$repo"/11/test/*/; do
+    name=$(basename "$program")
+    mkdir -p "$work/$name"
+    cp "$program"*.jack "$repo"/12/*.jack "$work/$name"
+    # Memory.allocateBlock miscomputes the remaining free length (Jack has
+    # no operator precedence), so the heap runs out during Output.init.
+    # Correct the copy so the programs get past start-up.
+    sed -i 's/endBlock\[freeList_length\] - next - endBlock;/endBlock[freeList_length] - (next - endBlock);/' \
+        "$work/$name/Memory.jack"
+    (cd "$work/$name" && "$compiler" -j 1 . > /dev/null)
+    rm "$work/$name"/*.jack
+
+    for flags in "${flagSets[@]}"; do
+        for fuse in "" "--fuse"; do
+            out=$work/run$fuse
+            (cd "$work" && "$vm" $flags $fuse "$name" > /dev/null)
+            echo "$(romWords "$work/$name.asm")" > "$out.rom"
+            "$emulator" -n "$cycles" -halt Sys.halt "$work/$name.asm" > "$out"
+        done
+
+        plain=$work/run; fused=$work/run--fuse
+        label="$name ${flags:-(default)}:"
+        sizes="rom $(cat "$plain.rom") -> $(cat "$fused.rom")"
+        plainEnd=$(grep -E '^(halted|stopped) ' "$plain")
+        fusedEnd=$(grep -E '^(halted|stopped) ' "$fused")
+
+        if [[ $plainEnd == halted* && $fusedEnd == halted* ]]; then
+            if cmp -s <(grep -Ev '^halted ' "$plain") <(grep -Ev '^halted ' "$fused"); then
+                echo "$label halted with the same state, $sizes, cycles ${plainEnd#halted } -> ${fusedEnd#halted }"
+                continue
+            fi
+        else
+            calls=$(grep -c '^call ' "$plain" "$fused" | cut -d: -f2 | sort -n | head -n 1)
+            grep '^call ' "$plain" | head -n "$calls" > "$plain.calls"
+            grep '^call ' "$fused" | head -n "$calls" > "$fused.calls"
+            if cmp -s "$plain.calls" "$fused.calls"; then
+                echo "$label first $calls calls match, $sizes"
+                continue
+            fi
+            plain=$plain.calls; fused=$fused.calls
+        fi
+
+        echo "$label MISMATCH between plain and --fuse runs"
+        diff "$plain" "$fused" | head -n 10
+        failed=1
+    done
+done
+
+exit $failed
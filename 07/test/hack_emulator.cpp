@@ -0,0 +1,329 @@
+// Runs translated Hack assembly directly, for checking that two
+// translations of the same VM program behave the same.
+//
+// ROM holds up to 64K words, twice the real machine's, so unoptimised
+// translations that are too big for the real ROM still run. The
+// emulator prints one line per function entered, with SP at entry, then
+// the final state:
+//
+//   call <function> <SP>
+//   ...
+//   halted|stopped <cycles>
+//   statics <RAM 16-255>
+//   heap <hash of RAM 2048-16383>
+//   screen <hash of RAM 16384-24575>
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+enum Jump : uint8_t { NONE, JGT, JEQ, JGE, JLT, JNE, JLE, JMP };
+
+struct Instruction {
+    bool isAddress;
+    int32_t value;
+    // Index into the computation table, over x = D and y = A or M
+    int comp;
+    bool useM;
+    bool destA, destD, destM;
+    Jump jump;
+};
+
+struct Program {
+    std::vector<Instruction> rom;
+    // Function entered at each ROM address, if any
+    std::vector<std::string> functions;
+    std::unordered_map<std::string, int32_t> labels;
+};
+
+void usage()
+{
+    std::cerr << "USAGE: hack_emulator [-n cycles] [-halt label] input.asm" << std::endl;
+    exit(2);
+};
+
+void fail(const std::string& message)
+{
+    std::cerr << "hack_emulator: " << message << std::endl;
+    exit(2);
+};
+
+std::string strip(const std::string& line)
+{
+    std::string stripped;
+    for (std::size_t i = 0; i < line.size(); i++) {
+        if (line[i] == '/' && i + 1 < line.size() && line[i + 1] == '/') {
+            break;
+        }
+        if (!isspace(static_cast<unsigned char>(line[i]))) {
+            stripped.push_back(line[i]);
+        }
+    }
+    return stripped;
+};
+
+// Function labels are Class.name. Labels within a function contain '$'
+// and return addresses are Class.name.RET.n.
+bool isFunction(const std::string& label)
+{
+    auto dot = label.find('.');
+    return dot != std::string::npos && label.find('.', dot + 1) == std::string::npos &&
+        label.find('$') == std::string::npos;
+};
+
+Jump parseJump(const std::string& jump)
+{
+    static const std::unordered_map<std::string, Jump> jumps = {
+        { "", NONE }, { "JGT", JGT }, { "JEQ", JEQ }, { "JGE", JGE },
+        { "JLT", JLT }, { "JNE", JNE }, { "JLE", JLE }, { "JMP", JMP }
+    };
+    auto found = jumps.find(jump);
+    if (found == jumps.end()) {
+        fail("bad jump " + jump);
+    }
+    return found->second;
+};
+
+int parseComp(const std::string& comp)
+{
+    static const std::unordered_map<std::string, int> comps = {
+        { "0", 0 }, { "1", 1 }, { "-1", 2 }, { "D", 3 }, { "A", 4 }, { "!D", 5 },
+        { "!A", 6 }, { "-D", 7 }, { "-A", 8 }, { "D+1", 9 }, { "A+1", 10 },
+        { "D-1", 11 }, { "A-1", 12 }, { "D+A", 13 }, { "A+D", 13 }, { "D-A", 14 },
+        { "A-D", 15 }, { "D&A", 16 }, { "A&D", 16 }, { "D|A", 17 }, { "A|D", 17 }
+    };
+    auto found = comps.find(comp);
+    if (found == comps.end()) {
+        fail("bad computation " + comp);
+    }
+    return found->second;
+};
+
+Instruction parseCompute(const std::string& line)
+{
+    Instruction instruction{};
+    std::string dest, comp = line, jump;
+
+    auto equals = comp.find('=');
+    if (equals != std::string::npos) {
+        dest = comp.substr(0, equals);
+        comp = comp.substr(equals + 1);
+    }
+    auto semicolon = comp.find(';');
+    if (semicolon != std::string::npos) {
+        jump = comp.substr(semicolon + 1);
+        comp = comp.substr(0, semicolon);
+    }
+
+    // M and A share a computation; only the operand differs
+    for (auto& c : comp) {
+        if (c == 'M') {
+            c = 'A';
+            instruction.useM = true;
+        }
+    }
+
+    instruction.comp = parseComp(comp);
+    instruction.destA = dest.find('A') != std::string::npos;
+    instruction.destD = dest.find('D') != std::string::npos;
+    instruction.destM = dest.find('M') != std::string::npos;
+    instruction.jump = parseJump(jump);
+    return instruction;
+};
+
+int16_t compute(int comp, int16_t x, int16_t y)
+{
+    switch (comp) {
+    case 0: return 0;
+    case 1: return 1;
+    case 2: return -1;
+    case 3: return x;
+    case 4: return y;
+    case 5: return ~x;
+    case 6: return ~y;
+    case 7: return -x;
+    case 8: return -y;
+    case 9: return x + 1;
+    case 10: return y + 1;
+    case 11: return x - 1;
+    case 12: return y - 1;
+    case 13: return x + y;
+    case 14: return x - y;
+    case 15: return y - x;
+    case 16: return x & y;
+    default: return x | y;
+    }
+};
+
+bool jumps(Jump jump, int16_t value)
+{
+    switch (jump) {
+    case JGT: return value > 0;
+    case JEQ: return value == 0;
+    case JGE: return value >= 0;
+    case JLT: return value < 0;
+    case JNE: return value != 0;
+    case JLE: return value <= 0;
+    case JMP: return true;
+    default: return false;
+    }
+};
+
+Program load(const std::string& path)
+{
+    std::ifstream input{path};
+    if (!input) {
+        fail("could not open " + path);
+    }
+
+    Program program{};
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(input, line)) {
+        line = strip(line);
+        if (line.empty()) {
+            continue;
+        }
+        if (line.front() == '(') {
+            auto label = line.substr(1, line.size() - 2);
+            program.labels.emplace(label, lines.size());
+            if (isFunction(label)) {
+                program.functions.resize(lines.size() + 1);
+                program.functions[lines.size()] = label;
+            }
+            continue;
+        }
+        lines.push_back(line);
+    }
+
+    std::unordered_map<std::string, int32_t> symbols = {
+        { "SP", 0 }, { "LCL", 1 }, { "ARG", 2 }, { "THIS", 3 }, { "THAT", 4 },
+        { "SCREEN", 16384 }, { "KBD", 24576 }
+    };
+    for (int i = 0; i < 16; i++) {
+        symbols.emplace("R" + std::to_string(i), i);
+    }
+    for (const auto& [label, address] : program.labels) {
+        symbols.emplace(label, address);
+    }
+
+    int32_t nextVariable = 16;
+    for (const auto& text : lines) {
+        if (text.front() != '@') {
+            program.rom.push_back(parseCompute(text));
+            continue;
+        }
+
+        Instruction instruction{};
+        instruction.isAddress = true;
+        auto symbol = text.substr(1);
+        if (isdigit(static_cast<unsigned char>(symbol.front()))) {
+            instruction.value = std::stoi(symbol);
+        } else {
+            auto [found, inserted] = symbols.emplace(symbol, nextVariable);
+            nextVariable += inserted;
+            instruction.value = found->second;
+        }
+        program.rom.push_back(instruction);
+    }
+
+    program.functions.resize(program.rom.size());
+    return program;
+};
+
+uint64_t hash(const std::vector<int16_t>& ram, int from, int to)
+{
+    uint64_t h = 1469598103934665603ull;
+    for (int i = from; i <= to; i++) {
+        h = (h ^ static_cast<uint16_t>(ram[i])) * 1099511628211ull;
+    }
+    return h;
+};
+
+}
+
+int main(int argc, char* argv[])
+{
+    long long maxCycles = 100000000;
+    std::string haltLabel{}, path{};
+    for (int i = 1; i < argc; i++) {
+        std::string arg{argv[i]};
+        if (arg == "-n" && i + 1 < argc) {
+            maxCycles = std::atoll(argv[++i]);
+        } else if (arg == "-halt" && i + 1 < argc) {
+            haltLabel = argv[++i];
+        } else if (arg.rfind("-", 0) != 0) {
+            path = arg;
+        } else {
+            usage();
+        }
+    }
+    if (path.empty()) {
+        usage();
+    }
+
+    auto program = load(path);
+    if (program.rom.size() > 65536) {
+        fail("program is too big to address");
+    }
+    int32_t haltAddress = -1;
+    if (!haltLabel.empty()) {
+        auto found = program.labels.find(haltLabel);
+        if (found == program.labels.end()) {
+            fail("no label " + haltLabel);
+        }
+        haltAddress = found->second;
+    }
+
+    // Jump targets are read as unsigned, which is what lets ROM reach 64K
+    std::vector<int16_t> ram(65536, 0);
+    int16_t a = 0, d = 0;
+    int32_t pc = 0;
+    long long cycles = 0;
+    auto size = static_cast<int32_t>(program.rom.size());
+
+    while (cycles < maxCycles && pc < size && pc != haltAddress) {
+        if (!program.functions[pc].empty()) {
+            std::cout << "call " << program.functions[pc] << " " << ram[0] << "\n";
+        }
+
+        const auto& instruction = program.rom[pc];
+        cycles++;
+        if (instruction.isAddress) {
+            a = static_cast<int16_t>(instruction.value);
+            pc++;
+            continue;
+        }
+
+        auto address = static_cast<uint16_t>(a);
+        auto y = instruction.useM ? ram[address] : a;
+        auto result = compute(instruction.comp, d, y);
+        if (instruction.destM) {
+            ram[address] = result;
+        }
+        if (instruction.destD) {
+            d = result;
+        }
+        if (instruction.destA) {
+            a = result;
+        }
+        pc = jumps(instruction.jump, result) ? address : pc + 1;
+    }
+
+    std::cout << (pc == haltAddress ? "halted " : "stopped ") << cycles << "\n";
+    std::cout << "statics";
+    for (int i = 16; i < 256; i++) {
+        std::cout << " " << ram[i];
+    }
+    std::cout << "\n";
+    std::cout << "heap " << std::hex << hash(ram, 2048, 16383) << "\n";
+    std::cout << "screen " << hash(ram, 16384, 24575) << std::dec << std::endl;
+
+    return 0;
+};
@@ -1,74 +1,233 @@
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <functional>
 #include <iostream>
-#include <sstream>
+#include <thread>
 #include "boost/filesystem.hpp"
 #include "parser.hpp"
+#include "call_graph.hpp"
 #include "code_writer.hpp"
 
 namespace fs = boost::filesystem;
 
-void process(CodeWriter& writer, fs::path input)
+// Reads and parses input into file, returning an error message on failure
+std::string load(const fs::path& input, VmFile& file)
 {
-    std::ifstream inputFile{input.string()};
-    writer.setCurrentFile(input.stem().string());
-
-    Parser parser{inputFile};
-
-    while (parser.hasMoreCommands()) {
-        parser.advance();
-
-        Command command = parser.parse();
-        switch(command.type) {
-        case CommandType::C_PUSH:
-        case CommandType::C_POP:
-            writer.writePushPop(command);
-            break;
-        case CommandType::C_ARITHMETIC:
-            writer.writeArithmetic(command);
-            break;
-        case CommandType::C_LABEL:
-            writer.writeLabel(command);
-            break;
-        case CommandType::C_GOTO:
-            writer.writeGoto(command);
-            break;
-        case CommandType::C_IF:
-            writer.writeIf(command);
-            break;
-        case CommandType::C_CALL:
-            writer.writeCall(command);
-            break;
-        case CommandType::C_FUNCTION:
-            writer.writeFunction(command);
-            break;
-        case CommandType::C_RETURN:
-            writer.writeReturn(command);
-            break;
+    std::ifstream inputFile{input.string(), std::ios::binary | std::ios::ate};
+    if (!inputFile) {
+        return "Could not open " + input.string();
+    }
+
+    file.name = input.stem().string();
+    file.source.resize(inputFile.tellg());
+    inputFile.seekg(0);
+    inputFile.read(file.source.data(), file.source.size());
+
+    Parser parser{{ file.source.data(), file.source.size() }, file.symbols};
+    try {
+        while (parser.hasMoreCommands()) {
+            parser.advance();
+
+            file.commands.push_back(parser.parse());
+        }
+    } catch (const InvalidCommand& e) {
+        return input.string() + ": Invalid command: " + e.what();
+    }
+
+    return "";
+};
+
+// Leaves out functions missing from keep, when given
+void process(CodeWriter& writer, const VmFile& file, const FunctionSet* keep)
+{
+    writer.setCurrentFile(file.name, file.symbols);
+
+    bool emitting = true;
+    for (const auto& command : file.commands) {
+        if (command.type == CommandType::C_FUNCTION) {
+            emitting = !keep || keep->count(std::string(file.symbols.name(command.symbol)));
+        }
+        if (emitting) {
+            writer.writeCommand(command);
+        }
+    }
+
+    writer.flush();
+};
+
+// Roughly what one command expands to, so most files never regrow their buffer
+const std::size_t bytesPerCommand = 64;
+
+// Output and static usage of one file, translated by its own writer
+struct Translation {
+    AsmBuffer code;
+    StaticUsage statics;
+};
+
+Translation translate(const VmFile& file, const CodeWriterOptions& options, const FunctionSet* keep)
+{
+    AsmBuffer out{file.commands.size() * bytesPerCommand};
+    CodeWriter writer{out, options};
+    process(writer, file, keep);
+    return { std::move(out), writer.staticUsage() };
+};
+
+void write(std::ofstream& output, const AsmBuffer& buffer)
+{
+    output.write(buffer.view().data(), buffer.view().size());
+};
+
+// Runs fn(i) for every i below count, each worker taking the next unclaimed index
+void forEachIndex(std::size_t count, unsigned int jobs, const std::function<void(std::size_t)>& fn)
+{
+    std::atomic<std::size_t> next{0};
+    auto worker = [&] {
+        for (auto i = next++; i < count; i = next++) {
+            fn(i);
         }
+    };
+
+    std::vector<std::thread> workers{};
+    for (std::size_t i = 1; i < std::min<std::size_t>(jobs, count); i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+};
+
+void usage()
+{
+    std::cerr << "USAGE: vm [--shared-calls] [--cache-stack-top] [--fuse] [--inline-compare] [--strip-unreachable] [--report-reachability] [--static-report] [-j jobs] input.vm" << std::endl;
+    exit(1);
+};
+
+// Static variables are allocated from RAM[16], and the stack starts at 256
+void staticReport(const StaticUsage& usage)
+{
+    const std::size_t capacity = 256 - 16;
+    std::size_t total = 0;
+    for (const auto& [file, indices] : usage) {
+        total += indices.size();
+    }
+
+    std::cout << "Static memory: " << total << " of " << capacity << " words";
+    if (total > 0) {
+        std::cout << " (RAM 16-" << 16 + total - 1 << ")";
+    }
+    std::cout << std::endl;
+    if (total > capacity) {
+        std::cout << "Static variables overflow into the stack" << std::endl;
+    }
+
+    for (const auto& [file, indices] : usage) {
+        std::cout << "  " << file << " " << indices.size() << std::endl;
     }
 };
 
 int main(int argc, char* argv[])
 {
-    if (argc != 2) {
-        std::cerr << "USAGE: vm input.vm" << std::endl;
-        exit(1);
+    CodeWriterOptions options{ false, false, false, false };
+    bool reportStatics = false;
+    bool stripUnreachable = false;
+    bool reportReachability = false;
+    unsigned int jobs = std::max(1u, std::thread::hardware_concurrency());
+    std::string inputName{};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg{argv[i]};
+        if (arg == "--shared-calls") {
+            options.sharedCalls = true;
+        } else if (arg == "--cache-stack-top") {
+            options.cacheTop = true;
+        } else if (arg == "--fuse") {
+            options.fusePatterns = true;
+        } else if (arg == "--inline-compare") {
+            options.inlineCompare = true;
+        } else if (arg == "--strip-unreachable") {
+            stripUnreachable = true;
+        } else if (arg == "--report-reachability") {
+            reportReachability = true;
+        } else if (arg == "--static-report") {
+            reportStatics = true;
+        } else if (arg == "-j" && i + 1 < argc) {
+            jobs = std::max(1, std::atoi(argv[++i]));
+        } else if (arg.rfind("-", 0) != 0 && inputName.empty()) {
+            inputName = arg;
+        } else {
+            usage();
+        }
     }
 
-    fs::path input{argv[1]};
-    std::ofstream outputFile{input.stem().string() + ".asm"};
-    CodeWriter writer{outputFile};
+    if (inputName.empty()) {
+        usage();
+    }
 
+    // Every file is loaded before anything is written, so that the call
+    // graph covers the whole program. Files are sorted by name so the
+    // output doesn't depend on directory order.
+    fs::path input{inputName};
+    std::vector<fs::path> paths{};
     if (fs::is_directory(input)) {
         for (const auto& entry : fs::directory_iterator(input)) {
-            const auto& file{entry.path()};
-
-            if (file.extension() == ".vm") {
-                process(writer, file);
+            if (entry.path().extension() == ".vm") {
+                paths.push_back(entry.path());
             }
         }
+        std::sort(paths.begin(), paths.end());
     } else {
-        process(writer, input);
+        paths.push_back(input);
+    }
+
+    std::vector<VmFile> files(paths.size());
+    std::vector<std::string> errors(paths.size());
+    forEachIndex(paths.size(), jobs, [&](std::size_t i) {
+        errors[i] = load(paths[i], files[i]);
+    });
+
+    bool failed = false;
+    for (const auto& error : errors) {
+        if (!error.empty()) {
+            std::cerr << error << std::endl;
+            failed = true;
+        }
+    }
+    if (failed) {
+        exit(1);
+    }
+
+    FunctionSet reachable{};
+    if (stripUnreachable || reportReachability) {
+        reachable = reachableFunctions(files);
+    }
+
+    // Generated labels are namespaced by file, so files can be translated
+    // independently and joined in order
+    std::vector<Translation> translations(files.size());
+    forEachIndex(files.size(), jobs, [&](std::size_t i) {
+        translations[i] = translate(files[i], options, stripUnreachable ? &reachable : nullptr);
+    });
+
+    AsmBuffer bootstrap{4096};
+    CodeWriter writer{bootstrap, options};
+    writer.writeBootstrap();
+
+    std::ofstream outputFile{input.stem().string() + ".asm"};
+    write(outputFile, bootstrap);
+
+    StaticUsage statics{};
+    for (const auto& translation : translations) {
+        write(outputFile, translation.code);
+        statics.insert(translation.statics.begin(), translation.statics.end());
+    }
+
+    if (reportReachability) {
+        std::cout << reachabilityReport(files, reachable) << std::endl;
+    }
+    if (reportStatics) {
+        staticReport(statics);
     }
 
     return 0;
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "CompilationEngine.hpp"
 
 template<typename T>
@@ -21,22 +22,6 @@ bool oneOf(T t, As... Fs)
     }
 };
 
-template<typename T>
-std::shared_ptr<Token> oneOfToken(T t)
-{
-    return t();
-};
-
-template<typename T, typename... As>
-std::shared_ptr<Token> oneOfToken(T t, As... Fs)
-{
-    try {
-        return t();
-    } catch (const CompilationError& e) {
-        return oneOfToken(Fs...);
-    }
-};
-
 std::map<SymbolKind::Enum, Segment::Enum> kindSegmentMap = {
     { SymbolKind::STATIC, Segment::STATIC },
     { SymbolKind::FIELD, Segment::THIS },
@@ -61,10 +46,10 @@ std::map<char, std::string> unaryOpCommandMap = {
     { '~', "not" },
 };
 
-const std::vector<char16_t> opList = {'+', '-', '*', '/', '&', '|', '<', '>', '='};
-const std::vector<std::string> opStringList = {"+", "-", "*", "/", "&", "|", "<", ">", "="};
+const std::string_view opList = "+-*/&|<>=";
 
-CompilationEngine::CompilationEngine(TokenList& tokens, std::ostream& out) : token(tokens.begin()), vmWriter(out), labelCount(0)
+CompilationEngine::CompilationEngine(JackTokenizer& tokenizer, StringPool& names, std::ostream& out)
+    : names(names), tokens(tokenizer), vmWriter(out), labelCount(0)
 {
     symbolTable = SymbolTable{};
 }
@@ -77,23 +62,31 @@ bool CompilationEngine::compile()
     try {
         compileClass();
     } catch (const CompilationError& e) {
-        std::cerr << "Compilation error: " << e.what() << std::endl;
+        errorMessage = e.what();
+        return false;
+    } catch (const FatalCompilationError& e) {
+        errorMessage = e.what();
         return false;
     }
 
     return true;
 };
 
+const std::string& CompilationEngine::error() const noexcept
+{
+    return errorMessage;
+};
+
 bool CompilationEngine::compileClass()
 {
     // 'class' className '{' classVarDec* subroutineDec* '}'
 
-    readKeyword({"class"});
+    readKeyword({Keyword::CLASS});
     const auto& ident = readIdentifier();
 
-    className = ident->valToString();
+    className = ident.id;
 
-    readSymbol({'{'});
+    readSymbol("{");
 
     zeroOrMany([this] { return compileClassVarDec(); });
     zeroOrMany([this] { return compileSubroutineDec(); });
@@ -105,21 +98,21 @@ bool CompilationEngine::compileClassVarDec()
 {
     // ('static' | 'field' ) type varName (',' varName)* ';'
 
-    if (!tokenMatches({"static", "field"})) return false;
+    if (!tokenMatches({Keyword::STATIC, Keyword::FIELD})) return false;
 
-    const auto& kw = readKeyword({"static", "field"});
-    const auto& type = readType();
+    const auto& kw = readKeyword({Keyword::STATIC, Keyword::FIELD});
+    auto type = readType();
     const auto& ident = readIdentifier();
 
-    auto symbol = symbolTable.addSymbol(ident, type, kw);
+    symbolTable.addSymbol(ident.id, type, kw.keyword());
 
-    while(tokenMatches({","})) {
-        token++;
+    while(tokenMatches(",")) {
+        tokens.next();
         const auto& ident = readIdentifier();
-        auto symbol = symbolTable.addSymbol(ident, type, kw);
+        symbolTable.addSymbol(ident.id, type, kw.keyword());
     }
 
-    readSymbol({';'});
+    readSymbol(";");
 
     return true;
 };
@@ -130,25 +123,26 @@ bool CompilationEngine::compileSubroutineDec()
     // ('void' | type) subroutineName '(' parameterList ')'
     // subroutineBody
 
-    if (!tokenMatches({"constructor", "function", "method"})) return false;
+    if (!tokenMatches({Keyword::CONSTRUCTOR, Keyword::FUNCTION, Keyword::METHOD})) return false;
 
     symbolTable.startSubroutine();
     vmWriter.write("// Compiling subroutine");
 
-    const auto& kw = readKeyword({"constructor", "function", "method"});
-    if (kw->valToString() == "method") {
-        symbolTable.addSymbol("this", className, SymbolKind::ARGUMENT);
+    const auto& kw = readKeyword({Keyword::CONSTRUCTOR, Keyword::FUNCTION, Keyword::METHOD});
+    if (kw.is(Keyword::METHOD)) {
+        symbolTable.addSymbol(names.intern("this"), className, SymbolKind::ARGUMENT);
     }
 
-    oneOfToken(
-               [this] { return readKeyword({"void"}); },
-               [this] { return readType(); }
-               );
+    if (tokenMatches({Keyword::VOID})) {
+        tokens.next();
+    } else {
+        readType();
+    }
     const auto& ident = readIdentifier();
 
-    readSymbol({'('});
+    readSymbol("(");
     compileParameterList();
-    readSymbol({')'});
+    readSymbol(")");
 
     compileSubroutineBody(ident, kw);
     vmWriter.write("// End subroutine");
@@ -160,20 +154,20 @@ bool CompilationEngine::compileParameterList()
 {
     // ((type varName) (',' type varName)*)?
 
-    if(!(tokenMatches({"int", "char", "boolean"}) || std::dynamic_pointer_cast<IdentifierToken>(*token))) { return false; }
+    if(!(tokenMatches({Keyword::INT, Keyword::CHAR, Keyword::BOOLEAN}) || tokens.peek().kind == TokenKind::IDENTIFIER)) { return false; }
 
-    if (!tokenMatches({")"})) {
-        const auto& type = readType();
+    if (!tokenMatches(")")) {
+        auto type = readType();
         const auto& ident = readIdentifier();
 
-        symbolTable.addSymbol(ident, type, SymbolKind::ARGUMENT);
+        symbolTable.addSymbol(ident.id, type, SymbolKind::ARGUMENT);
 
-        while (tokenMatches({","})) {
-            token++;
-            const auto& type = readType();
+        while (tokenMatches(",")) {
+            tokens.next();
+            auto type = readType();
             const auto& ident = readIdentifier();
 
-            symbolTable.addSymbol(ident, type, SymbolKind::ARGUMENT);
+            symbolTable.addSymbol(ident.id, type, SymbolKind::ARGUMENT);
         }
     }
 
@@ -184,52 +178,52 @@ bool CompilationEngine::compileVarDec()
 {
     // 'var' type varName (',' varName)* ';'
 
-    if (!tokenMatches({"var"})) return false;
+    if (!tokenMatches({Keyword::VAR})) return false;
 
-    const auto& kw = readKeyword({"var"});
-    const auto& type = readType();
+    const auto& kw = readKeyword({Keyword::VAR});
+    auto type = readType();
     const auto& ident = readIdentifier();
 
-    symbolTable.addSymbol(ident, type, kw);
+    symbolTable.addSymbol(ident.id, type, kw.keyword());
 
-    while (tokenMatches({","})) {
-        token++;
+    while (tokenMatches(",")) {
+        tokens.next();
         const auto& ident = readIdentifier();
-        symbolTable.addSymbol(ident, type, kw);
+        symbolTable.addSymbol(ident.id, type, kw.keyword());
     }
 
-    readSymbol({';'});
+    readSymbol(";");
 
     return true;
 };
 
-bool CompilationEngine::compileSubroutineBody(const std::shared_ptr<Token> name, const std::shared_ptr<Token> kw)
+bool CompilationEngine::compileSubroutineBody(const Token& name, const Token& kw)
 {
     // '{' varDec* statements '}'
 
     // Change this pattern to readSymbol
-    if (!tokenMatches({"{"})) return false;
+    if (!tokenMatches("{")) return false;
 
     vmWriter.write("// Compiling subroutine body");
-    readSymbol({'{'});
+    readSymbol("{");
 
     zeroOrMany([this] { return compileVarDec(); });
 
     // TODO add 1 for methods
-    vmWriter.writeFunction(className + "." + name->valToString(), symbolTable.getCount(SymbolKind::VAR));
+    vmWriter.writeFunction(names.name(className), names.name(name.id), symbolTable.getCount(SymbolKind::VAR));
 
-    if (kw->valToString() == "constructor") {
+    if (kw.is(Keyword::CONSTRUCTOR)) {
         vmWriter.writePush(Segment::CONST, symbolTable.getCount(SymbolKind::FIELD));
         vmWriter.writeCall("Memory.alloc", 1);
         vmWriter.writePop(Segment::POINTER, 0);
-    } else if (kw->valToString() == "method") {
+    } else if (kw.is(Keyword::METHOD)) {
         vmWriter.writePush(Segment::ARG, 0);
         vmWriter.writePop(Segment::POINTER, 0);
     }
 
     compileStatements();
 
-    readSymbol({'}'});
+    readSymbol("}");
     vmWriter.write("// End subroutine body");
 
     return true;
@@ -240,7 +234,7 @@ bool CompilationEngine::compileStatements()
     // statement*
 
     // TODO logging semicolon so not incrementing token somewhere
-    if (!tokenMatches({"let", "if", "else", "while", "do", "return"})) return false;
+    if (!tokenMatches({Keyword::LET, Keyword::IF, Keyword::ELSE, Keyword::WHILE, Keyword::DO, Keyword::RETURN})) return false;
 
     zeroOrMany([this] { return compileStatement(); });
 
@@ -264,27 +258,27 @@ bool CompilationEngine::compileLet()
 {
     // 'let' varName ('[' expression ']')? '=' expression ';'
 
-    if (!tokenMatches({"let"})) return false;
+    if (!tokenMatches({Keyword::LET})) return false;
 
     bool arrayAccess = false;
 
     vmWriter.write("// Compiling let");
-    readKeyword({"let"});
-    const auto& ident = symbolTable.getSymbol(readIdentifier()->valToString());
-    auto segment = kindSegmentMap.at(ident->kind);
+    readKeyword({Keyword::LET});
+    const auto& ident = lookup(readIdentifier());
+    auto segment = kindSegmentMap.at(ident.kind);
 
-    if (tokenMatches({"["})) {
-        token++;
+    if (tokenMatches("[")) {
+        tokens.next();
         arrayAccess = true;
-        vmWriter.writePush(segment, ident->id);
+        vmWriter.writePush(segment, ident.id);
         compileExpression();
-        readSymbol({']'});
+        readSymbol("]");
         vmWriter.write("add");
     }
 
-    readSymbol({'='});
+    readSymbol("=");
     compileExpression();
-    readSymbol({';'});
+    readSymbol(";");
 
     if (arrayAccess) {
         vmWriter.writePop(Segment::TEMP, 1);
@@ -292,7 +286,7 @@ bool CompilationEngine::compileLet()
         vmWriter.writePush(Segment::TEMP, 1);
         vmWriter.writePop(Segment::THAT, 0);
     } else {
-        vmWriter.writePop(segment, ident->id);
+        vmWriter.writePop(segment, ident.id);
     }
 
     return true;
@@ -302,36 +296,36 @@ bool CompilationEngine::compileIf()
 {
     // 'if '(' expression ')' '{' statements '}' ('else' '{' statements '}')?
 
-    if (!tokenMatches({"if"})) return false;
+    if (!tokenMatches({Keyword::IF})) return false;
 
     vmWriter.write("// Compiling if");
-    readKeyword({"if"});
+    readKeyword({Keyword::IF});
     auto endLabel = newLabel();
 
-    readSymbol({'('});
+    readSymbol("(");
     compileExpression();
-    readSymbol({')'});
+    readSymbol(")");
 
     vmWriter.write("not");
     auto notLabel = newLabel();
-    vmWriter.writeIf(notLabel);
+    vmWriter.writeIf(names.name(className), notLabel);
 
-    readSymbol({ '{' });
+    readSymbol("{");
     compileStatements();
-    readSymbol({ '}' });
+    readSymbol("}");
 
-    vmWriter.writeGoto(endLabel);
-    vmWriter.writeLabel(notLabel);
+    vmWriter.writeGoto(names.name(className), endLabel);
+    vmWriter.writeLabel(names.name(className), notLabel);
 
-    if (tokenMatches({"else"})) {
-        token++;
+    if (tokenMatches({Keyword::ELSE})) {
+        tokens.next();
         vmWriter.write("// Compiling else");
-        readSymbol({'{'});
+        readSymbol("{");
         compileStatements();
-        readSymbol({'}'});
+        readSymbol("}");
     }
 
-    vmWriter.writeLabel(endLabel);
+    vmWriter.writeLabel(names.name(className), endLabel);
 
     return true;
 };
@@ -340,27 +334,27 @@ bool CompilationEngine::compileWhile()
 {
     // 'while' '(' expression ')' '{' statements '}'
 
-    if (!tokenMatches({"while"})) return false;
+    if (!tokenMatches({Keyword::WHILE})) return false;
 
     vmWriter.write("// Compiling while");
-    readKeyword({"while"});
+    readKeyword({Keyword::WHILE});
     auto topLabel = newLabel();
-    vmWriter.writeLabel(topLabel);
+    vmWriter.writeLabel(names.name(className), topLabel);
 
-    readSymbol({'('});
+    readSymbol("(");
     compileExpression();
-    readSymbol({')'});
+    readSymbol(")");
 
     vmWriter.write("not");
     auto notLabel = newLabel();
-    vmWriter.writeIf(notLabel);
+    vmWriter.writeIf(names.name(className), notLabel);
 
-    readSymbol({ '{' });
+    readSymbol("{");
     compileStatements();
-    readSymbol({ '}' });
+    readSymbol("}");
 
-    vmWriter.writeGoto(topLabel);
-    vmWriter.writeLabel(notLabel);
+    vmWriter.writeGoto(names.name(className), topLabel);
+    vmWriter.writeLabel(names.name(className), notLabel);
 
     return true;
 };
@@ -369,14 +363,14 @@ bool CompilationEngine::compileDo()
 {
     // 'do' subroutineCall ';'
 
-    if (!tokenMatches({"do"})) return false;
+    if (!tokenMatches({Keyword::DO})) return false;
 
     vmWriter.write("// Compiling do");
-    readKeyword({"do"});
+    readKeyword({Keyword::DO});
 
     compileSubroutineCall();
 
-    readSymbol({';'});
+    readSymbol(";");
     vmWriter.writePop(Segment::TEMP, 0);
 
     return true;
@@ -386,12 +380,12 @@ bool CompilationEngine::compileReturn()
 {
     // 'return' expression? ';'
 
-    if (!tokenMatches({"return"})) return false;
+    if (!tokenMatches({Keyword::RETURN})) return false;
 
     vmWriter.write("// Compiling return");
-    readKeyword({"return"});
+    readKeyword({Keyword::RETURN});
 
-    if (!tokenMatches({";"})) {
+    if (!tokenMatches(";")) {
         zeroOrOnce([this] { return compileExpression(); });
     } else {
         vmWriter.writePush(Segment::CONST, 0);
@@ -399,7 +393,7 @@ bool CompilationEngine::compileReturn()
 
     vmWriter.writeReturn();
 
-    readSymbol({';'});
+    readSymbol(";");
 
     return true;
 };
@@ -411,10 +405,10 @@ bool CompilationEngine::compileExpression()
     compileTerm();
 
     zeroOrMany([this] {
-        if (tokenMatches(opStringList)) {
+        if (tokenMatches(opList)) {
             const auto& op = readSymbol(opList);
             compileTerm();
-            vmWriter.write(opCommandMap.at(op->getVal()));
+            vmWriter.write(opCommandMap.at(op.symbol()));
             // token++;
             return true;
         }
@@ -435,34 +429,33 @@ bool CompilationEngine::compileTerm()
           [this] { return compileStringConst(); },
           [this] { return compileKeywordConstant(); },
           [this] {
-              if (tokenMatches({"("})) {
-                  token++;
+              if (tokenMatches("(")) {
+                  tokens.next();
                   compileExpression();
-                  readSymbol({')'});
+                  readSymbol(")");
                   return true;
               }
               return false;
           },
           [this] { return compileUnaryOp(); },
           [this] {
-              auto identTok = std::dynamic_pointer_cast<IdentifierToken>(*token);
-              if (identTok == nullptr) { return false; }
+              if (tokens.peek().kind != TokenKind::IDENTIFIER) { return false; }
 
-              const auto& next = std::next(token);
-              if ((*next)->valToString() == "." || (*next)->valToString() == "(") {
+              const auto& next = tokens.peek(1);
+              if (next.is('.') || next.is('(')) {
                   // TODO - do I need to pass in ident?
                   return compileSubroutineCall();
               }
 
-              const auto& ident = symbolTable.getSymbol(identTok->valToString());
-              auto segment = kindSegmentMap.at(ident->kind);
+              const auto& ident = lookup(tokens.peek());
+              auto segment = kindSegmentMap.at(ident.kind);
 
-              token++;
-              if (tokenMatches({"["})) {
-                  token++;
-                  vmWriter.writePush(segment, ident->id);
+              tokens.next();
+              if (tokenMatches("[")) {
+                  tokens.next();
+                  vmWriter.writePush(segment, ident.id);
                   compileExpression();
-                  readSymbol({']'});
+                  readSymbol("]");
                   vmWriter.write("add");
                   vmWriter.writePop(Segment::POINTER, 1);
                   vmWriter.writePush(Segment::THAT, 0);
@@ -470,7 +463,7 @@ bool CompilationEngine::compileTerm()
                   return true;
               }
 
-              vmWriter.writePush(segment, ident->id);
+              vmWriter.writePush(segment, ident.id);
               return true;
           });
 
@@ -482,21 +475,19 @@ bool CompilationEngine::compileSubroutineCall()
     // subroutineName '(' expressionList ')' | (className | varName)
     // '.' subroutineName '(' expressionList ')'
 
-    std::string typeName{};
-    std::string name{};
+    StringId typeName, name;
     int numArgs = 0;
 
     // TODO increment num args correctly throughout
-    auto next = std::next(token);
-    if ((*next)->valToString() == ".") {
+    if (tokens.peek(1).is('.')) {
         const auto& ident = readIdentifier();
-        readSymbol({'.'});
+        readSymbol(".");
 
-        auto symbol = symbolTable.getSymbol(ident->valToString());
+        auto symbol = symbolTable.getSymbol(ident.id);
 
-        if (symbol.get() == nullptr) {
+        if (symbol == nullptr) {
             // it's a class
-            typeName = ident->valToString();
+            typeName = ident.id;
         } else {
             typeName = symbol->type;
             auto segment = kindSegmentMap.at(symbol->kind);
@@ -504,23 +495,24 @@ bool CompilationEngine::compileSubroutineCall()
             vmWriter.writePush(segment, symbol->id);
         }
         const auto& methodName = readIdentifier();
-        name = typeName + "." + methodName->valToString();
+        name = methodName.id;
 
     } else {
         const auto& ident = readIdentifier();
         numArgs = 1;
         vmWriter.writePush(Segment::POINTER, 0);
-        name = className + "." + ident->valToString();
+        typeName = className;
+        name = ident.id;
     }
 
-    readSymbol({'('});
-    if (!tokenMatches({")"})) {
+    readSymbol("(");
+    if (!tokenMatches(")")) {
         numArgs += compileExpressionList();
     }
 
-    readSymbol({')'});
+    readSymbol(")");
 
-    vmWriter.writeCall(name, numArgs);
+    vmWriter.writeCall(names.name(typeName), names.name(name), numArgs);
 
     return true;
 };
@@ -532,8 +524,8 @@ int CompilationEngine::compileExpressionList()
     int numArgs = 0;
     compileExpression();
     numArgs++;
-    while (tokenMatches({","})) {
-        token++;
+    while (tokenMatches(",")) {
+        tokens.next();
         compileExpression();
         numArgs++;
     }
@@ -544,9 +536,11 @@ bool CompilationEngine::compileUnaryOp()
 {
     // '-' | '~' term
 
-    const auto& op = readSymbol({'~', '-'});
+    if (!tokenMatches("~-")) return false;
+
+    const auto& op = readSymbol("~-");
     compileTerm();
-    vmWriter.write(unaryOpCommandMap.at(op->getVal()));
+    vmWriter.write(unaryOpCommandMap.at(op.symbol()));
     return true;
 };
 
@@ -554,11 +548,13 @@ bool CompilationEngine::compileKeywordConstant()
 {
     // 'true'| 'false' | 'null' | 'this'
 
-    const auto& kw = readKeyword({"true", "false", "null", "this"});
-    if (kw->valToString() == "true") {
+    if (!tokenMatches({Keyword::TRUE, Keyword::FALSE, Keyword::NULL_VAL, Keyword::THIS})) return false;
+
+    const auto& kw = readKeyword({Keyword::TRUE, Keyword::FALSE, Keyword::NULL_VAL, Keyword::THIS});
+    if (kw.is(Keyword::TRUE)) {
         vmWriter.writePush(Segment::CONST, 1);
         vmWriter.write("neg");
-    } else if (kw->valToString() == "false" || kw->valToString() == "null") {
+    } else if (kw.is(Keyword::FALSE) || kw.is(Keyword::NULL_VAL)) {
         vmWriter.writePush(Segment::CONST, 0);
     } else {
         vmWriter.writePush(Segment::POINTER, 0);
@@ -568,33 +564,27 @@ bool CompilationEngine::compileKeywordConstant()
 
 bool CompilationEngine::compileIntConst()
 {
-    const auto intTok = std::dynamic_pointer_cast<IntConstToken>(*token);
-    if (intTok == nullptr) {
-        throw CompilationError(expected("intConst", *token));
-    }
+    if (tokens.peek().kind != TokenKind::INT_CONST) return false;
 
-    vmWriter.writePush(Segment::CONST, std::stoi(intTok->valToString()));
+    vmWriter.writePush(Segment::CONST, tokens.peek().value);
 
-    token++;
+    tokens.next();
 
     return true;
 };
 
 bool CompilationEngine::compileStringConst()
 {
-    auto strTok = std::dynamic_pointer_cast<StringToken>(*token);
-    if (strTok == nullptr) {
-        throw CompilationError(expected("stringConst", *token));
-    }
+    if (tokens.peek().kind != TokenKind::STRING_CONST) return false;
 
-    auto string = strTok->getVal();
+    auto string = names.name(tokens.peek().id);
     vmWriter.writePush(Segment::CONST, string.length());
     vmWriter.writeCall("String.new", 1);
     for (const char& c : string) {
         vmWriter.writePush(Segment::CONST, int(c));
         vmWriter.writeCall("String.appendChar", 2);
     }
-    token++;
+    tokens.next();
 
     return true;
 };
@@ -602,64 +592,62 @@ bool CompilationEngine::compileStringConst()
 // Private helper methods
 // ======================
 
-std::shared_ptr<Token> CompilationEngine::readType()
+StringId CompilationEngine::readType()
 {
     // 'int' | 'char' | 'boolean' | className
 
-    return oneOfToken(
-                      [this] { return readKeyword({"int", "char", "boolean"}); },
-                      [this] { return readIdentifier(); }
-                      );
+    if (tokenMatches({Keyword::INT, Keyword::CHAR, Keyword::BOOLEAN})) {
+        return names.intern(keywordNames[static_cast<size_t>(tokens.next().keyword())]);
+    }
+    return readIdentifier().id;
 };
 
-std::shared_ptr<KeywordToken> CompilationEngine::readKeyword(const std::vector<std::string>& options)
+Token CompilationEngine::readKeyword(std::initializer_list<Keyword> options)
 {
-    auto kwToken = std::dynamic_pointer_cast<KeywordToken>(*token);
-    if (kwToken == nullptr) {
-        throw CompilationError(expected("keyword", *token));
+    if (tokens.peek().kind != TokenKind::KEYWORD) {
+        throw CompilationError(expected("keyword", tokens.peek()));
     }
 
     for (auto& option : options) {
-        if(kwToken->getVal() == option) {
-            token++;
-            return kwToken;
+        if (tokens.peek().keyword() == option) {
+            return tokens.next();
         }
     }
 
-    throw CompilationError(expected("keyword", *token));
+    throw CompilationError(expected("keyword", tokens.peek()));
 };
 
-std::shared_ptr<IdentifierToken> CompilationEngine::readIdentifier()
+Token CompilationEngine::readIdentifier()
 {
-    auto identToken = std::dynamic_pointer_cast<IdentifierToken>(*token);
-    if (identToken == nullptr) {
-        throw CompilationError(expected("identifier", *token));
+    if (tokens.peek().kind != TokenKind::IDENTIFIER) {
+        throw CompilationError(expected("identifier", tokens.peek()));
     }
 
-    token++;
-    return identToken;
+    return tokens.next();
 };
 
-std::shared_ptr<SymbolToken> CompilationEngine::readSymbol(const std::vector<char16_t>& options)
+Token CompilationEngine::readSymbol(std::string_view options)
 {
-    auto symbolToken = std::dynamic_pointer_cast<SymbolToken>(*token);
-    if (symbolToken == nullptr) {
-        throw CompilationError(expected("symbol", *token));
+    if (tokens.peek().kind != TokenKind::SYMBOL) {
+        throw CompilationError(expected("symbol", tokens.peek()));
     }
 
-    for (auto& option : options) {
-        if (symbolToken->getVal() == option) {
-            token++;
-            return symbolToken;
-        }
+    if (options.find(tokens.peek().symbol()) != std::string_view::npos) {
+        return tokens.next();
     }
 
-    throw CompilationError(expected("symbol", *token));
+    throw CompilationError(expected("symbol", tokens.peek()));
+};
+
+bool CompilationEngine::tokenMatches(std::initializer_list<Keyword> options)
+{
+    return tokens.peek().kind == TokenKind::KEYWORD &&
+        std::find(std::begin(options), std::end(options), tokens.peek().keyword()) != std::end(options);
 };
 
-bool CompilationEngine::tokenMatches(std::vector<std::string> options)
+bool CompilationEngine::tokenMatches(std::string_view symbols)
 {
-    return std::find(std::begin(options), std::end(options), (*token)->valToString()) != std::end(options);
+    return tokens.peek().kind == TokenKind::SYMBOL && symbols.find(tokens.peek().symbol()) != std::string_view::npos;
 };
 
 bool CompilationEngine::zeroOrOnce(const std::function<void(void)>& F)
@@ -682,14 +670,24 @@ bool CompilationEngine::zeroOrMany(const std::function<bool(void)>& F)
     }
 };
 
-const std::string CompilationEngine::expected(const std::string& expect, const std::shared_ptr<Token>& got)
+const std::string CompilationEngine::expected(const std::string& expect, const Token& got)
 {
     std::stringstream ss{};
-    ss << "l" << got->getLineNumber() << ": expected " << expect << ", received '" << got->valToString() << "'" << std::endl;
+    ss << "l" << got.lineNumber << ": expected " << expect << ", received '" << valToString(got, names) << "'";
     return ss.str();
 };
 
-const std::string CompilationEngine::newLabel()
+const Symbol& CompilationEngine::lookup(const Token& ident)
+{
+    auto symbol = symbolTable.getSymbol(ident.id);
+    if (symbol == nullptr) {
+        throw FatalCompilationError("l" + std::to_string(ident.lineNumber) + ": undeclared variable '" +
+                                    std::string(names.name(ident.id)) + "'");
+    }
+    return *symbol;
+};
+
+int CompilationEngine::newLabel()
 {
-    return className + ".label." + std::to_string(labelCount++);
+    return labelCount++;
 };
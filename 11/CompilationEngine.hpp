@@ -1,25 +1,31 @@
 #ifndef __CompilationEngine__
 #define __CompilationEngine__
 
+#include <functional>
+#include <initializer_list>
 #include <string>
+#include <string_view>
 #include <iostream>
 #include "Tokens.hpp"
 #include "JackTokenizer.hpp"
+#include "TokenStream.hpp"
 #include "CompilationError.hpp"
+#include "StringPool.hpp"
 #include "SymbolTable.hpp"
 #include "VMWriter.hpp"
 
 class CompilationEngine {
 public:
-    CompilationEngine(TokenList& tokens, std::ostream&);
+    CompilationEngine(JackTokenizer& tokenizer, StringPool& names, std::ostream&);
     ~CompilationEngine() = default;
     bool compile();
+    const std::string& error() const noexcept;
     bool compileClass();
     bool compileClassVarDec();
     bool compileSubroutineDec();
     bool compileParameterList();
     bool compileVarDec();
-    bool compileSubroutineBody(const std::shared_ptr<Token> name, const std::shared_ptr<Token> kw);
+    bool compileSubroutineBody(const Token& name, const Token& kw);
     bool compileStatements();
     bool compileStatement();
     bool compileLet();
@@ -36,18 +42,22 @@ public:
     bool compileIntConst();
     bool compileStringConst();
 private:
-    std::shared_ptr<Token> readType();
-    std::shared_ptr<KeywordToken> readKeyword(const std::vector<std::string>& options);
-    std::shared_ptr<IdentifierToken> readIdentifier();
-    std::shared_ptr<SymbolToken> readSymbol(const std::vector<char16_t>& options);
-    bool tokenMatches(std::vector<std::string>);
+    StringId readType();
+    Token readKeyword(std::initializer_list<Keyword> options);
+    Token readIdentifier();
+    Token readSymbol(std::string_view options);
+    bool tokenMatches(std::initializer_list<Keyword> options);
+    bool tokenMatches(std::string_view symbols);
     bool zeroOrOnce(const std::function<void(void)>&);
     bool zeroOrMany(const std::function<bool(void)>&);
-    const std::string expected(const std::string&, const std::shared_ptr<Token>&);
-  const std::string newLabel();
-    std::vector<std::shared_ptr<Token>>::iterator token;
+    const std::string expected(const std::string&, const Token&);
+    const Symbol& lookup(const Token& ident);
+  int newLabel();
+    StringPool& names;
+    TokenStream tokens;
     VMWriter vmWriter;
-    std::string className;
+    StringId className;
+    std::string errorMessage;
     SymbolTable symbolTable;
     int labelCount;
 };
@@ -7,10 +7,20 @@
 class CompilationError : public std::exception {
 public:
     CompilationError(const char* msg) : msg(msg) { }
-    CompilationError(std::string msg) : CompilationError(msg.c_str()) { }
-    const char* what() const noexcept { return msg; }
+    CompilationError(std::string msg) : msg(std::move(msg)) { }
+    const char* what() const noexcept { return msg.c_str(); }
 private:
-    const char* msg;
+    std::string msg;
+};
+
+// Not a CompilationError, so it is not swallowed while the engine tries
+// the next alternative, and reaches compile() instead
+class FatalCompilationError : public std::exception {
+public:
+    FatalCompilationError(std::string msg) : msg(std::move(msg)) { }
+    const char* what() const noexcept { return msg.c_str(); }
+private:
+    std::string msg;
 };
 
 #endif
@@ -1,40 +1,122 @@
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
 #include "boost/filesystem.hpp"
 #include "JackTokenizer.hpp"
 #include "CompilationEngine.hpp"
 
 namespace fs = boost::filesystem;
 
+void usage()
+{
+    std::cerr << "USAGE: JackAnalyser [-j jobs] [file.jack|dir]" << std::endl;
+    exit(1);
+};
+
+// Compiles one class to a .vm file in the working directory, returning
+// the error message if it fails
+std::string compileFile(const fs::path& filePath)
+{
+    std::ifstream file{filePath.string()};
+    if (!file) {
+        return "Could not open " + filePath.string();
+    }
+    std::ofstream outputFile{filePath.stem().string() + ".vm"};
+
+    StringPool names{};
+    JackTokenizer tokenizer{file, names};
+    CompilationEngine compiler{tokenizer, names, outputFile};
+    if (!compiler.compile()) {
+        return "Compilation error in " + filePath.filename().string() + ": " + compiler.error();
+    }
+    return "";
+};
+
+// Runs fn(i) for every i below count, each worker taking the next unclaimed index
+void forEachIndex(std::size_t count, unsigned int jobs, const std::function<void(std::size_t)>& fn)
+{
+    std::atomic<std::size_t> next{0};
+    auto worker = [&] {
+        for (auto i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+
+    std::vector<std::thread> workers{};
+    for (std::size_t i = 1; i < std::min<std::size_t>(jobs, count); i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+};
+
 int main(int argc, char* argv[])
 {
-    if (argc != 2) {
-        std::cerr << "USAGE: JackAnalyser [file.jack|dir]" << std::endl;
-        exit(1);
+    unsigned int jobs = std::max(1u, std::thread::hardware_concurrency());
+    std::string inputName{};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg{argv[i]};
+        if (arg == "-j" && i + 1 < argc) {
+            jobs = std::max(1, std::atoi(argv[++i]));
+        } else if (arg.rfind("-", 0) != 0 && inputName.empty()) {
+            inputName = arg;
+        } else {
+            usage();
+        }
+    }
+
+    if (inputName.empty()) {
+        usage();
     }
 
+    // Sorted so that errors are reported in the same order on every run
     std::vector<fs::path> filesToProcess{};
-    fs::path input{argv[1]};
+    fs::path input{inputName};
     if (fs::is_directory(input)) {
         for (const auto& entry : fs::directory_iterator(input)) {
             if (entry.path().extension() == ".jack") {
                 filesToProcess.push_back(entry.path());
             }
         }
+        std::sort(filesToProcess.begin(), filesToProcess.end());
     } else {
         filesToProcess.push_back(input);
     }
 
-    for (const auto& filePath : filesToProcess) {
-        std::ifstream file{filePath.string()};
-        std::ofstream outputFile{filePath.stem().string() + ".vm"};
+    // Every class compiles on its own. The largest files are handed out
+    // first so a big class doesn't start last and hold up the rest.
+    std::vector<std::uintmax_t> sizes(filesToProcess.size());
+    std::vector<std::size_t> order(filesToProcess.size());
+    for (std::size_t i = 0; i < filesToProcess.size(); i++) {
+        boost::system::error_code ec;
+        sizes[i] = fs::file_size(filesToProcess[i], ec);
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return sizes[a] > sizes[b];
+    });
 
-        JackTokenizer tokenizer{file};
-        auto tokens = tokenizer.getTokenList();
+    std::vector<std::string> errors(filesToProcess.size());
+    forEachIndex(order.size(), jobs, [&](std::size_t k) {
+        auto i = order[k];
+        errors[i] = compileFile(filesToProcess[i]);
+    });
 
-        CompilationEngine compiler{tokens, outputFile};
-        compiler.compile();
+    bool failed = false;
+    for (const auto& error : errors) {
+        if (!error.empty()) {
+            std::cerr << error << std::endl;
+            failed = true;
+        }
     }
 
-    return 0;
+    return failed ? 1 : 0;
 };
@@ -1,196 +1,206 @@
-#include <regex>
+#include <array>
 #include "JackTokenizer.hpp"
 
-std::map<std::string, Keyword> validKeywords = {
-    { "class",       Keyword::CLASS },
-    { "constructor", Keyword::CONSTRUCTOR },
-    { "function",    Keyword::FUNCTION },
-    { "method",      Keyword::METHOD },
-    { "field",       Keyword::FIELD },
-    { "static",      Keyword::STATIC },
-    { "var",         Keyword::VAR },
-    { "int",         Keyword::INT },
-    { "char",        Keyword::CHAR },
-    { "boolean",     Keyword::BOOLEAN },
-    { "void",        Keyword::VOID },
-    { "true",        Keyword::TRUE },
-    { "false",       Keyword::FALSE },
-    { "null",        Keyword::NULL_VAL },
-    { "this",        Keyword::THIS },
-    { "let",         Keyword::LET },
-    { "do",          Keyword::DO },
-    { "if",          Keyword::IF },
-    { "else",        Keyword::ELSE },
-    { "while",       Keyword::WHILE },
-    { "return",      Keyword::RETURN },
-};
-
-std::unordered_set<char16_t> validSymbols = {
-    '{',
-    '}',
-    '(',
-    ')',
-    '[',
-    ']',
-    '.',
-    ',',
-    ';',
-    '+',
-    '-',
-    '*',
-    '/',
-    '&',
-    '|',
-    '<',
-    '>',
-    '=',
-    '~',
-};
+namespace {
 
-JackTokenizer::JackTokenizer(std::istream& in) : input(in), lineNumber(0), multilineCommentBlock(false) { };
-
-bool JackTokenizer::isCommentLine(std::string::iterator& it)
-{
-    if (multilineCommentBlock) {
-        return currentLine.find("*/") == std::string::npos;
-    }
-    return *it == '/' && *std::next(it) == '/';
-};
+enum CharClass : uint8_t { OTHER, SPACE, NEWLINE, SYMBOL, QUOTE, DIGIT, LETTER };
 
-void JackTokenizer::skipCommentBlock(std::string::iterator& it)
+constexpr std::array<CharClass, 256> makeCharClasses()
 {
-    if (multilineCommentBlock) {
-        while (!(*it == '*' && *std::next(it) == '/')) {
-            it++;
+    std::array<CharClass, 256> classes{};
+    for (int c = 0; c < 256; c++) {
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') {
+            classes[c] = LETTER;
+        } else if (c >= '0' && c <= '9') {
+            classes[c] = DIGIT;
         }
-        multilineCommentBlock = false;
-        std::advance(it, 2);
     }
-
-    if (!(*it == '/' && *std::next(it) == '*')) {
-        return;
+    for (char c : std::string_view{" \t\r\v\f"}) {
+        classes[static_cast<unsigned char>(c)] = SPACE;
+    }
+    for (char c : std::string_view{"{}()[].,;+-*/&|<>=~"}) {
+        classes[static_cast<unsigned char>(c)] = SYMBOL;
     }
+    classes['\n'] = NEWLINE;
+    classes['"'] = QUOTE;
+    return classes;
+}
 
-    std::advance(it, 2);
+constexpr auto charClasses = makeCharClasses();
 
-    while (!(*it == '*' && *std::next(it) == '/')) {
-        it++;
-        if (it == currentLine.end()) {
-            multilineCommentBlock = true;
-            return;
-        }
-    }
+CharClass charClass(char c)
+{
+    return charClasses[static_cast<unsigned char>(c)];
+}
 
-    std::advance(it, 2);
-};
+// Every keyword lands in its own slot; found by brute force over small multipliers
+constexpr uint32_t keywordHash(std::string_view word)
+{
+    return (word.size() * 3 + static_cast<unsigned char>(word[0]) * 14 +
+            static_cast<unsigned char>(word[1]) * 2) & 31;
+}
 
-bool JackTokenizer::isRemainingChar(std::string::iterator& it)
+constexpr std::array<int8_t, 32> makeKeywordSlots()
 {
-    while (isspace(*it)) {
-        it++;
+    std::array<int8_t, 32> slots{};
+    for (auto& slot : slots) {
+        slot = -1;
     }
-
-    if (isCommentLine(it)) {
-        return false;
+    for (size_t i = 0; i < keywordNames.size(); i++) {
+        slots[keywordHash(keywordNames[i])] = static_cast<int8_t>(i);
     }
+    return slots;
+}
 
-    skipCommentBlock(it);
+constexpr auto keywordSlots = makeKeywordSlots();
 
-    if (it == currentLine.end()) {
-        return false;
+static_assert([] {
+    for (size_t i = 0; i < keywordNames.size(); i++) {
+        if (keywordSlots[keywordHash(keywordNames[i])] != static_cast<int8_t>(i)) {
+            return false;
+        }
     }
-
     return true;
-};
+}(), "keyword hash must be collision free");
 
-TokenList JackTokenizer::getTokenList()
+int findKeyword(std::string_view word)
 {
-    TokenList tokenList{};
-    std::string currentEl;
-    while(std::getline(input, currentLine)) {
-        lineNumber++;
-        std::string::iterator it = currentLine.begin();
-        while(isRemainingChar(it)) {
-            std::string token{};
-            if (isSymbol(*it)) {
-                token.append(1, *it++);
-            } else {
-                // handle string constants
-                if (*it == '\"') {
-                    token.append(1, *it++);
-                    while (it != currentLine.end() && *it != '\"') {
-                        token.append(1, *it++);
-                    }
-
-                    token.append(1, *it++);
-                } else {
-                    while (it != currentLine.end() && !isspace(*it) && !isSymbol(*it)) {
-                        token.append(1, *it++);
-                    }
-                }
-            }
-            tokenList.push_back(nextToken(token));
-        }
+    if (word.size() < 2 || word.size() > 11) {
+        return -1;
     }
+    auto slot = keywordSlots[keywordHash(word)];
+    return slot >= 0 && keywordNames[slot] == word ? slot : -1;
+}
 
-    return tokenList;
-};
+}
 
-std::shared_ptr<Token> JackTokenizer::nextToken(const std::string& input)
+JackTokenizer::JackTokenizer(std::istream& in, StringPool& names) : names(names), pos(0), lineNumber(1)
 {
-    if (isKeyword(input)) {
-        return std::make_shared<KeywordToken>(input, lineNumber);
-    }
-    if (isSymbol(input.c_str()[0])) {
-        auto symbol = input.c_str()[0];
-        return std::make_shared<SymbolToken>(symbol, lineNumber);
-    }
-    if (isInteger(input)) {
-        return std::make_shared<IntConstToken>(std::stoi(input), lineNumber);
+    // Size the buffer up front when the stream can report its length
+    in.seekg(0, std::ios::end);
+    auto size = in.tellg();
+    in.seekg(0, std::ios::beg);
+    in.clear();
+    if (size > 0) {
+        source.reserve(static_cast<size_t>(size));
     }
-    if (isString(input)) {
-        // strip double quotes
-        const auto& str = input.substr(1, input.size() - 2);
-        return std::make_shared<StringToken>(str, lineNumber);
-    }
-    if (isIdentifier(input)) {
-        return std::make_shared<IdentifierToken>(input, lineNumber);
+
+    char chunk[65536];
+    while (in.read(chunk, sizeof(chunk)) || in.gcount() > 0) {
+        source.append(chunk, in.gcount());
     }
-    return std::make_shared<Token>(lineNumber);
 };
 
-bool JackTokenizer::isKeyword(const std::string& input)
+void JackTokenizer::skipSpaceAndComments()
 {
-    return validKeywords.count(input);
-};
+    auto end = source.size();
+    while (pos < end) {
+        switch (charClass(source[pos])) {
+        case NEWLINE:
+            lineNumber++;
+            // fall through
+        case SPACE:
+            pos++;
+            continue;
+        default:
+            break;
+        }
 
-bool JackTokenizer::isSymbol(char16_t input)
-{
-    return validSymbols.find(input) != validSymbols.end();
+        if (source[pos] != '/' || pos + 1 == end) {
+            return;
+        }
+
+        if (source[pos + 1] == '/') {
+            auto newline = source.find('\n', pos);
+            pos = newline == std::string::npos ? end : newline;
+        } else if (source[pos + 1] == '*') {
+            auto close = source.find("*/", pos + 2);
+            auto stop = close == std::string::npos ? end : close + 2;
+            for (; pos < stop; pos++) {
+                lineNumber += source[pos] == '\n';
+            }
+        } else {
+            return;
+        }
+    }
 };
 
-bool JackTokenizer::isInteger(const std::string& input)
+Token JackTokenizer::next()
 {
-    std::string::const_iterator it = input.begin();
+    skipSpaceAndComments();
 
-    while (it != input.end() && isdigit(*it)) {++it; }
-
-    if (it == input.end()) {
-        int num = std::stoi(input);
-        return num >= 0 && num <= 32767;
+    if (pos == source.size()) {
+        return { TokenKind::END, 0, 0, pos, lineNumber };
     }
 
-    return false;
+    auto start = pos;
+    switch (charClass(source[pos])) {
+    case SYMBOL:
+        pos++;
+        return { TokenKind::SYMBOL, static_cast<int16_t>(source[start]), 0, start, lineNumber };
+    case QUOTE:
+        return stringConst(start);
+    default:
+        return word(start);
+    }
 };
 
-bool JackTokenizer::isString(const std::string& input)
+// A run up to the next space, symbol or quote: an integer constant,
+// keyword or identifier, or an invalid token
+Token JackTokenizer::word(uint32_t start)
 {
-    const std::regex pattern{R"(^\"[[:print:]]+\"$)"};
-    return std::regex_match(input, pattern);
+    bool digits = true, identifier = charClass(source[start]) == LETTER;
+    int32_t value = 0;
+
+    for (; pos < source.size(); pos++) {
+        auto c = source[pos];
+        switch (charClass(c)) {
+        case DIGIT:
+            value = value * 10 + (c - '0');
+            if (value > 32767) {
+                value = 32768;
+            }
+            continue;
+        case LETTER:
+            digits = false;
+            continue;
+        case OTHER:
+            digits = identifier = false;
+            continue;
+        default:
+            break;
+        }
+        break;
+    }
+
+    if (digits) {
+        if (value <= 32767) {
+            return { TokenKind::INT_CONST, static_cast<int16_t>(value), 0, start, lineNumber };
+        }
+    } else if (identifier) {
+        auto text = std::string_view{source}.substr(start, pos - start);
+        auto kw = findKeyword(text);
+        if (kw >= 0) {
+            return { TokenKind::KEYWORD, static_cast<int16_t>(kw), 0, start, lineNumber };
+        }
+        return { TokenKind::IDENTIFIER, 0, names.intern(text), start, lineNumber };
+    }
+    return { TokenKind::NONE, 0, 0, start, lineNumber };
 };
 
-bool JackTokenizer::isIdentifier(const std::string& input)
+// String constants end at the closing quote and may not span lines.
+// The interned text leaves out the quotes.
+Token JackTokenizer::stringConst(uint32_t start)
 {
-    const std::regex pattern{R"(^[a-zA-Z_]+[a-zA-Z0-9_]*)"};
-    return std::regex_match(input, pattern);
+    for (pos = start + 1; pos < source.size(); pos++) {
+        if (source[pos] == '"') {
+            pos++;
+            auto text = std::string_view{source}.substr(start + 1, pos - start - 2);
+            return { TokenKind::STRING_CONST, 0, names.intern(text), start, lineNumber };
+        }
+        if (source[pos] == '\n') {
+            break;
+        }
+    }
+    return { TokenKind::NONE, 0, 0, start, lineNumber };
 };
@@ -1,59 +1,26 @@
 #ifndef __JackTokenizer__
 #define __JackTokenizer__
 
+#include <cstdint>
 #include <istream>
-#include <iostream>
-#include <sstream>
 #include <string>
-#include <map>
-#include <unordered_set>
-#include <vector>
+#include "StringPool.hpp"
 #include "Tokens.hpp"
 
-enum class Keyword {
-    CLASS,
-    CONSTRUCTOR,
-    FUNCTION,
-    METHOD,
-    FIELD,
-    STATIC,
-    VAR,
-    INT,
-    CHAR,
-    BOOLEAN,
-    VOID,
-    TRUE,
-    FALSE,
-    NULL_VAL,
-    THIS,
-    LET,
-    DO,
-    IF,
-    ELSE,
-    WHILE,
-    RETURN
-};
-
-typedef std::vector<std::shared_ptr<Token>> TokenList;
-
+// Reads the whole input into one buffer and scans it byte by byte,
+// interning identifiers and string constants as it goes.
 class JackTokenizer {
 public:
-    explicit JackTokenizer(std::istream&);
-    std::vector<std::shared_ptr<Token>> getTokenList();
+    JackTokenizer(std::istream&, StringPool& names);
+    Token next();
 private:
-    bool isRemainingChar(std::string::iterator&);
-    bool isCommentLine(std::string::iterator&);
-    void skipCommentBlock(std::string::iterator&);
-    std::shared_ptr<Token> nextToken(const std::string&);
-    bool isKeyword(const std::string&);
-    bool isSymbol(char16_t);
-    bool isInteger(const std::string&);
-    bool isString(const std::string&);
-    bool isIdentifier(const std::string&);
-    std::istream& input;
-    std::string currentLine;
+    void skipSpaceAndComments();
+    Token word(uint32_t start);
+    Token stringConst(uint32_t start);
+    StringPool& names;
+    std::string source;
+    uint32_t pos;
     int lineNumber;
-    bool multilineCommentBlock;
 };
 
 #endif
@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <cstring>
+#include "StringPool.hpp"
+
+const size_t chunkSize = 16384;
+
+StringPool::StringPool() : used(0), capacity(0)
+{
+    ids.reserve(512);
+    names.reserve(512);
+};
+
+StringId StringPool::intern(std::string_view text)
+{
+    auto entry = ids.find(text);
+    if (entry != ids.end()) {
+        return entry->second;
+    }
+
+    auto id = static_cast<StringId>(names.size());
+    auto stored = store(text);
+    ids.emplace(stored, id);
+    names.push_back(stored);
+    return id;
+};
+
+std::string_view StringPool::name(StringId id) const noexcept
+{
+    return names[id];
+};
+
+size_t StringPool::size() const noexcept
+{
+    return names.size();
+};
+
+// Copies text to the end of the current chunk, starting a new one when it
+// does not fit. Long strings get a chunk of their own.
+std::string_view StringPool::store(std::string_view text)
+{
+    if (chunks.empty() || text.size() > capacity - used) {
+        capacity = std::max(chunkSize, text.size());
+        chunks.push_back(std::make_unique<char[]>(capacity));
+        used = 0;
+    }
+
+    char* start = chunks.back().get() + used;
+    std::memcpy(start, text.data(), text.size());
+    used += text.size();
+    return { start, text.size() };
+};
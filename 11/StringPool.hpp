@@ -0,0 +1,29 @@
+#ifndef __StringPool__
+#define __StringPool__
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+typedef uint32_t StringId;
+
+// Interns identifiers and string constants for one compilation. Text is
+// copied into arena chunks, so names stay valid for the pool's lifetime
+// and equal names always get the same id.
+class StringPool {
+public:
+    StringPool();
+    StringId intern(std::string_view text);
+    std::string_view name(StringId id) const noexcept;
+    size_t size() const noexcept;
+private:
+    std::string_view store(std::string_view text);
+    std::vector<std::unique_ptr<char[]>> chunks;
+    size_t used, capacity;
+    std::unordered_map<std::string_view, StringId> ids;
+    std::vector<std::string_view> names;
+};
+
+#endif
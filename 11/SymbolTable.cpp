@@ -4,20 +4,19 @@
 // TODOs
 // cerr
 
-const std::string Symbol::toString() const
+const std::string Symbol::toString(const StringPool& names) const
 {
     return "<identifier kind='" +
         SymbolKind::toString(kind) +
-        "' type='" + type +
+        "' type='" + std::string(names.name(type)) +
         "' id='" + std::to_string(id) +
-        "'>" + name + "</identifier>";
+        "'>" + std::string(names.name(name)) + "</identifier>";
 };
 
-std::map<std::string, SymbolKind::Enum> symbolMap = {
-    { "static", SymbolKind::STATIC },
-    { "field", SymbolKind::FIELD },
-    { "argument", SymbolKind::ARGUMENT },
-    { "var", SymbolKind::VAR },
+std::map<Keyword, SymbolKind::Enum> symbolMap = {
+    { Keyword::STATIC, SymbolKind::STATIC },
+    { Keyword::FIELD, SymbolKind::FIELD },
+    { Keyword::VAR, SymbolKind::VAR },
 };
 
 void SymbolTable::startSubroutine()
@@ -27,17 +26,12 @@ void SymbolTable::startSubroutine()
     varCount = 0;
 };
 
-Symbol SymbolTable::addSymbol(std::shared_ptr<Token> name, std::shared_ptr<Token> type, std::shared_ptr<Token> kind)
+Symbol SymbolTable::addSymbol(StringId name, StringId type, Keyword kind)
 {
-    return addSymbol(name->valToString(), type->valToString(), symbolMap.at(kind->valToString()));
+    return addSymbol(name, type, symbolMap.at(kind));
 };
 
-Symbol SymbolTable::addSymbol(std::shared_ptr<Token> name, std::shared_ptr<Token> type, const SymbolKind::Enum& kind)
-{
-    return addSymbol(name->valToString(), type->valToString(), kind);
-};
-
-Symbol SymbolTable::addSymbol(const std::string& name, const std::string& type, const SymbolKind::Enum& kind)
+Symbol SymbolTable::addSymbol(StringId name, StringId type, const SymbolKind::Enum& kind)
 {
     int count = 0;
     switch (kind) {
@@ -68,15 +62,15 @@ Symbol SymbolTable::addSymbol(const std::string& name, const std::string& type,
     return entry;
 };
 
-std::shared_ptr<Symbol> SymbolTable::getSymbol(const std::string& name)
+const Symbol* SymbolTable::getSymbol(StringId name) const
 {
     auto srIter = subroutineMap.find(name);
     if (srIter != subroutineMap.end()) {
-        return std::make_shared<Symbol>(srIter->second);
+        return &srIter->second;
     }
     auto cIter = classMap.find(name);
     if (cIter != classMap.end()) {
-        return std::make_shared<Symbol>(cIter->second);
+        return &cIter->second;
     }
     return nullptr;
 };
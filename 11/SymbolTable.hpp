@@ -5,6 +5,7 @@
 #include <string>
 #include <sstream>
 
+#include "StringPool.hpp"
 #include "Tokens.hpp"
 
 struct SymbolKind {
@@ -26,11 +27,11 @@ struct SymbolKind {
 };
 
 struct Symbol {
-    std::string name;
-    std::string type;
+    StringId name;
+    StringId type;
     SymbolKind::Enum kind;
     int id;
-    const std::string toString() const;
+    const std::string toString(const StringPool& names) const;
 };
 
 class SymbolTable {
@@ -38,14 +39,13 @@ public:
     SymbolTable() = default;
     ~SymbolTable() = default;
     void startSubroutine();
-    Symbol addSymbol(std::shared_ptr<Token> name, std::shared_ptr<Token> type, std::shared_ptr<Token> kind);
-    Symbol addSymbol(std::shared_ptr<Token> name, std::shared_ptr<Token> type, const SymbolKind::Enum& kind);
-    Symbol addSymbol(const std::string& name, const std::string& type, const SymbolKind::Enum& kind);
-    std::shared_ptr<Symbol> getSymbol(const std::string& name);
+    Symbol addSymbol(StringId name, StringId type, Keyword kind);
+    Symbol addSymbol(StringId name, StringId type, const SymbolKind::Enum& kind);
+    const Symbol* getSymbol(StringId name) const;
     int getCount(const SymbolKind::Enum& kind);
 private:
-    std::map<std::string, Symbol> classMap;
-    std::map<std::string, Symbol> subroutineMap;
+    std::map<StringId, Symbol> classMap;
+    std::map<StringId, Symbol> subroutineMap;
     int staticCount = 0;
     int fieldCount = 0;
     int argumentCount = 0;
@@ -0,0 +1,28 @@
+#include "TokenStream.hpp"
+#include "CompilationError.hpp"
+
+static_assert((TokenStream::DEPTH & (TokenStream::DEPTH - 1)) == 0, "DEPTH must be a power of two");
+
+TokenStream::TokenStream(JackTokenizer& tokenizer) : tokenizer(tokenizer), head(0), count(0) { };
+
+const Token& TokenStream::peek(size_t k)
+{
+    // A bug in the engine, not in the source, so it must not be taken
+    // for an alternative that failed to match
+    if (k >= DEPTH) {
+        throw FatalCompilationError("internal error: lookahead of " + std::to_string(k) + " tokens is too deep");
+    }
+    while (count <= k) {
+        ring[(head + count) & (DEPTH - 1)] = tokenizer.next();
+        count++;
+    }
+    return ring[(head + k) & (DEPTH - 1)];
+};
+
+Token TokenStream::next()
+{
+    Token token = peek();
+    head = (head + 1) & (DEPTH - 1);
+    count--;
+    return token;
+};
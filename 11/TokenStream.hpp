@@ -0,0 +1,22 @@
+#ifndef __TokenStream__
+#define __TokenStream__
+
+#include <array>
+#include "JackTokenizer.hpp"
+#include "Tokens.hpp"
+
+// Pulls tokens from the tokenizer on demand, keeping only the few the
+// compiler has peeked at but not consumed
+class TokenStream {
+public:
+    explicit TokenStream(JackTokenizer& tokenizer);
+    const Token& peek(size_t k = 0);
+    Token next();
+    static constexpr size_t DEPTH = 4;
+private:
+    JackTokenizer& tokenizer;
+    std::array<Token, DEPTH> ring;
+    size_t head, count;
+};
+
+#endif
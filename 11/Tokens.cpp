@@ -1,50 +1,52 @@
 #include "Tokens.hpp"
 
-const std::string KeywordToken::toString() const
+const std::string keywordToString(Keyword kw)
 {
-    return "<keyword>" + val + "</keyword>";
+    return std::string(keywordNames[static_cast<size_t>(kw)]);
 };
 
-const std::string SymbolToken::toString() const
+const std::string valToString(const Token& token, const StringPool& names)
 {
-    std::string sym(1, val);
-    if (sym[0] == '<') {
-        sym = "&lt;";
+    switch (token.kind) {
+    case TokenKind::KEYWORD:
+        return keywordToString(token.keyword());
+    case TokenKind::SYMBOL:
+        return std::string(1, token.symbol());
+    case TokenKind::INT_CONST:
+        return std::to_string(token.value);
+    case TokenKind::STRING_CONST:
+    case TokenKind::IDENTIFIER:
+        return std::string(names.name(token.id));
+    default:
+        return "";
     }
-    else if (sym[0] == '>') {
-        sym = "&gt;";
-    }
-    else if (sym[0] == '\"') {
-        sym = "&quot;";
-    }
-    else if (sym[0] == '&') {
-        sym = "&amp;";
-    }
-    return "<symbol>" + sym + "</symbol>";
-};
-
-const std::string SymbolToken::valToString() const
-{
-    std::string symbol(1, val);
-    return symbol;
-};
-
-const std::string IntConstToken::toString() const
-{
-    return "<integerConstant>" + std::to_string(val) + "</integerConstant>";
-};
-
-const std::string IntConstToken::valToString() const
-{
-    return std::to_string(val);
 };
 
-const std::string StringToken::toString() const
+const std::string toString(const Token& token, const StringPool& names)
 {
-    return "<stringConstant>" + val.substr(1, val.size() - 2) + "</stringConstant>";
-};
-
-const std::string IdentifierToken::toString() const
-{
-    return "<identifier>" + val + "</identifier>";
+    switch (token.kind) {
+    case TokenKind::KEYWORD:
+        return "<keyword>" + valToString(token, names) + "</keyword>";
+    case TokenKind::SYMBOL:
+        switch (token.symbol()) {
+        case '<':
+            return "<symbol>&lt;</symbol>";
+        case '>':
+            return "<symbol>&gt;</symbol>";
+        case '\"':
+            return "<symbol>&quot;</symbol>";
+        case '&':
+            return "<symbol>&amp;</symbol>";
+        default:
+            return "<symbol>" + valToString(token, names) + "</symbol>";
+        }
+    case TokenKind::INT_CONST:
+        return "<integerConstant>" + valToString(token, names) + "</integerConstant>";
+    case TokenKind::STRING_CONST:
+        return "<stringConstant>" + valToString(token, names) + "</stringConstant>";
+    case TokenKind::IDENTIFIER:
+        return "<identifier>" + valToString(token, names) + "</identifier>";
+    default:
+        return "";
+    }
 };
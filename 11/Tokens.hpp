@@ -1,69 +1,71 @@
 #ifndef __Tokens__
 #define __Tokens__
 
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include "StringPool.hpp"
 
-class Token {
-public:
-    Token(int line) : lineNumber(line) { };
-    virtual ~Token() = default;
-    virtual const std::string toString() const { return ""; };
-    virtual const std::string valToString() const { return ""; };
-    int getLineNumber() const noexcept { return lineNumber; };
-    template<typename T>
-    T* instance() { return dynamic_cast<T *>(this); }
-protected:
-    int lineNumber;
+enum class Keyword : uint8_t {
+    CLASS,
+    CONSTRUCTOR,
+    FUNCTION,
+    METHOD,
+    FIELD,
+    STATIC,
+    VAR,
+    INT,
+    CHAR,
+    BOOLEAN,
+    VOID,
+    TRUE,
+    FALSE,
+    NULL_VAL,
+    THIS,
+    LET,
+    DO,
+    IF,
+    ELSE,
+    WHILE,
+    RETURN
 };
 
-class KeywordToken : public Token {
-public:
-    KeywordToken(std::string kw, int line) : Token(line), val(kw) { };
-    const std::string getVal() const noexcept { return val; };
-    const std::string toString() const override;
-    const std::string valToString() const override { return val; };
-private:
-    std::string val;
+enum class TokenKind : uint8_t {
+    NONE,
+    KEYWORD,
+    SYMBOL,
+    INT_CONST,
+    STRING_CONST,
+    IDENTIFIER,
+    END
 };
 
-class SymbolToken : public Token {
-public:
-    SymbolToken(char16_t symbol, int line) : Token(line), val(symbol) { };
-    const char16_t getVal() const noexcept { return val; };
-    const std::string toString() const override;
-    const std::string valToString() const override;
-private:
-    char16_t val;
+// Indexed by Keyword
+constexpr std::array<std::string_view, 21> keywordNames = {
+    "class", "constructor", "function", "method", "field", "static", "var",
+    "int", "char", "boolean", "void", "true", "false", "null", "this",
+    "let", "do", "if", "else", "while", "return"
 };
 
-class IntConstToken : public Token {
-public:
-    IntConstToken(int16_t intVal, int line) : Token(line), val(intVal) { };
-    const int16_t getVal() const noexcept { return val; };
-    const std::string toString() const override;
-    const std::string valToString() const override;
-private:
-    int16_t val;
+// Keywords, symbols and integer constants carry their value inline.
+// Identifiers and string constants carry their interned id.
+struct Token {
+    TokenKind kind;
+    int16_t value;
+    StringId id;
+    uint32_t offset;
+    int32_t lineNumber;
+    Keyword keyword() const noexcept { return static_cast<Keyword>(value); };
+    char symbol() const noexcept { return static_cast<char>(value); };
+    bool is(Keyword kw) const noexcept { return kind == TokenKind::KEYWORD && keyword() == kw; };
+    bool is(char sym) const noexcept { return kind == TokenKind::SYMBOL && symbol() == sym; };
 };
 
-class StringToken : public Token {
-public:
-    StringToken(const std::string& stringVal, int line) : Token(line), val(stringVal) { };
-    const std::string getVal() const noexcept { return val; };
-    const std::string toString() const override;
-    const std::string valToString() const override { return val; };
-private:
-    std::string val;
-};
+static_assert(sizeof(Token) == 16, "tokens should stay 16 bytes");
 
-class IdentifierToken : public Token {
-public:
-    IdentifierToken(const std::string& val, int line) : Token(line), val(val) { };
-    const std::string getVal() const noexcept { return val; };
-    const std::string toString() const override;
-    const std::string valToString() const override { return val; };
-private:
-    std::string val;
-};
+const std::string keywordToString(Keyword kw);
+const std::string valToString(const Token& token, const StringPool& names);
+const std::string toString(const Token& token, const StringPool& names);
 
 #endif
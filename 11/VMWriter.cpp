@@ -4,12 +4,12 @@ VMWriter::VMWriter(std::ostream& out) : out(out) { };
 
 void VMWriter::writePush(const Segment::Enum& segment, int index)
 {
-    write("push", Segment::toString(segment), std::to_string(index));
+    out << "push " << Segment::toString(segment) << " " << index << '\n';
 };
 
 void VMWriter::writePop(const Segment::Enum& segment, int index)
 {
-    write("pop", Segment::toString(segment), std::to_string(index));
+    out << "pop " << Segment::toString(segment) << " " << index << '\n';
 };
 
 void VMWriter::writeArithmetic(const Command::Enum& cmd)
@@ -17,29 +17,34 @@ void VMWriter::writeArithmetic(const Command::Enum& cmd)
     write(Command::toString(cmd));
 };
 
-void VMWriter::writeLabel(const std::string& label)
+void VMWriter::writeLabel(std::string_view className, int label)
 {
-    write("label", label);
+    writeLabelled("label", className, label);
 };
 
-void VMWriter::writeGoto(const std::string& label)
+void VMWriter::writeGoto(std::string_view className, int label)
 {
-    write("goto", label);
+    writeLabelled("goto", className, label);
 };
 
-void VMWriter::writeIf(const std::string& label)
+void VMWriter::writeIf(std::string_view className, int label)
 {
-    write("if-goto", label);
+    writeLabelled("if-goto", className, label);
 };
 
-void VMWriter::writeCall(const std::string& name, int nArgs)
+void VMWriter::writeCall(std::string_view name, int nArgs)
 {
-    write("call", name, std::to_string(nArgs));
+    out << "call " << name << " " << nArgs << '\n';
 };
 
-void VMWriter::writeFunction(const std::string& name, int nLocals)
+void VMWriter::writeCall(std::string_view className, std::string_view name, int nArgs)
 {
-    write("function", name, std::to_string(nLocals));
+    writeNamed("call", className, name, nArgs);
+};
+
+void VMWriter::writeFunction(std::string_view className, std::string_view name, int nLocals)
+{
+    writeNamed("function", className, name, nLocals);
 };
 
 void VMWriter::writeReturn()
@@ -47,8 +52,19 @@ void VMWriter::writeReturn()
     write("return");
 };
 
-bool VMWriter::write(const std::string& cmd, const std::string& arg1, const std::string& arg2)
+bool VMWriter::write(std::string_view cmd, std::string_view arg1, std::string_view arg2)
 {
-    out << cmd << " " << arg1 << " " << arg2 << std::endl;
+    out << cmd << " " << arg1 << " " << arg2 << '\n';
     return out.good();
 };
+
+// Labels are numbered per class: className.label.N
+void VMWriter::writeLabelled(std::string_view cmd, std::string_view className, int label)
+{
+    out << cmd << " " << className << ".label." << label << " " << '\n';
+};
+
+void VMWriter::writeNamed(std::string_view cmd, std::string_view className, std::string_view name, int n)
+{
+    out << cmd << " " << className << "." << name << " " << n << '\n';
+};
@@ -3,6 +3,7 @@
 
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <map>
 
 #include "SymbolTable.hpp"
@@ -63,14 +64,17 @@ public:
     void writePush(const Segment::Enum& segment, int index);
     void writePop(const Segment::Enum& segment, int index);
     void writeArithmetic(const Command::Enum& cmd);
-    void writeLabel(const std::string& label);
-    void writeGoto(const std::string& label);
-    void writeIf(const std::string& label);
-    void writeCall(const std::string& name, int nArgs);
-    void writeFunction(const std::string& name, int nLocals);
+    void writeLabel(std::string_view className, int label);
+    void writeGoto(std::string_view className, int label);
+    void writeIf(std::string_view className, int label);
+    void writeCall(std::string_view name, int nArgs);
+    void writeCall(std::string_view className, std::string_view name, int nArgs);
+    void writeFunction(std::string_view className, std::string_view name, int nLocals);
     void writeReturn();
-    bool write(const std::string& cmd, const std::string& arg1 = "", const std::string& arg2 = "");
+    bool write(std::string_view cmd, std::string_view arg1 = "", std::string_view arg2 = "");
 private:
+    void writeLabelled(std::string_view cmd, std::string_view className, int label);
+    void writeNamed(std::string_view cmd, std::string_view className, std::string_view name, int n);
     std::ostream& out;
 };
 
@@ -0,0 +1,55 @@
+// Linked into JackAnalyzer_count to count heap allocations and thrown
+// exceptions over a whole run. The totals go to stderr at exit.
+// Exceptions are counted by wrapping __cxa_throw, so the binary must be
+// linked with -Wl,--wrap=__cxa_throw.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<unsigned long> allocations{0}, allocatedBytes{0}, exceptions{0};
+
+struct Report {
+    ~Report()
+    {
+        std::fprintf(stderr, "allocations %lu (%lu bytes), exceptions thrown %lu\n",
+                allocations.load(), allocatedBytes.load(), exceptions.load());
+    };
+} report;
+
+}
+
+void* operator new(std::size_t size)
+{
+    allocations++;
+    allocatedBytes += size;
+    if (void* p = std::malloc(size > 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+};
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+};
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+};
+
+extern "C" {
+
+[[noreturn]] void __real___cxa_throw(void* exception, void* type, void (*destructor)(void*));
+
+[[noreturn]] void __wrap___cxa_throw(void* exception, void* type, void (*destructor)(void*))
+{
+    exceptions++;
+    __real___cxa_throw(exception, type, destructor);
+};
+
+}
@@ -0,0 +1,46 @@
+// Times the tokenizer alone on one file, best of three runs.
+// USAGE: TokenizerBench input.jack
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "JackTokenizer.hpp"
+#include "StringPool.hpp"
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2) {
+        std::cerr << "USAGE: TokenizerBench input.jack" << std::endl;
+        return 1;
+    }
+
+    std::ifstream input{argv[1], std::ios::binary};
+    if (!input) {
+        std::cerr << "Could not open " << argv[1] << std::endl;
+        return 1;
+    }
+    std::stringstream source;
+    source << input.rdbuf();
+
+    double best = 0;
+    size_t tokens = 0;
+    for (int run = 0; run < 3; run++) {
+        source.clear();
+        source.seekg(0);
+        auto start = std::chrono::steady_clock::now();
+        StringPool names{};
+        JackTokenizer tokenizer{source, names};
+        tokens = 0;
+        while (tokenizer.next().kind != TokenKind::END) {
+            tokens++;
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (run == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+
+    std::cout << "tokenize: " << tokens << " tokens in " << static_cast<long>(best) << " ms" << std::endl;
+    return 0;
+};
@@ -0,0 +1,23 @@
+#!/bin/bash
+# Counts heap allocations and exceptions thrown while compiling the OS
+# with Pong, then a generated class. Expects JackAnalyzer_count in 11,
+# which make count builds first. FUNCTIONS sets the size of the class.
+
+set -e
+
+here=$(cd "$(dirname "$0")" && pwd)
+root=$(dirname "$here")
+repo=$(dirname "$root")
+functions=${FUNCTIONS:-150000}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+mkdir "$work/pong" "$work/big"
+cp "$repo"/12/*.jack "$root"/test/Pong/*.jack "$work/pong"
+"$here/generate_jack.sh" "$functions" > "$work/big/Big.jack"
+
+echo -n "OS + Pong ($(ls "$work/pong" | wc -l) files): "
+(cd "$work" && "$root/JackAnalyzer_count" -j 1 pong 2>&1 > /dev/null)
+echo -n "generated class ($functions functions): "
+(cd "$work" && "$root/JackAnalyzer_count" -j 1 big/Big.jack 2>&1 > /dev/null)
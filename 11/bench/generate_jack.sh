@@ -0,0 +1,28 @@
+#!/bin/bash
+# Writes one synthetic Jack class with the given number of functions to
+# stdout, for benchmarking the compiler. Each function declares locals,
+# and uses expressions, a comment, if/else, a while loop, calls and a
+# string constant. 150000 functions make about 36 MB.
+#
+# USAGE: generate_jack.sh functions [class]
+
+if [ $# -lt 1 ]; then
+    echo "USAGE: generate_jack.sh functions [class]" >&2
+    exit 1
+fi
+
+awk -v functions="$1" -v class="${2:-Big}" 'BEGIN {
+    print "class " class " {"
+    print "  field int count;"
+    for (k = 0; k < functions; k++) {
+        print "  function int f" k "(int a, int b) {"
+        print "    var int x, y;"
+        print "    let x = a * 3 + (b / 2) - " k % 32000 ";"
+        print "    // keep going"
+        print "    if (x > 10) { let y = x - 1; } else { do Output.printString(\"value\"); }"
+        print "    while (y < a) { let y = y + " class ".f0(y, b); }"
+        print "    return x;"
+        print "  }"
+    }
+    print "}"
+}'
@@ -0,0 +1,36 @@
+#!/bin/bash
+# Times the tokenizer on 20 copies of the OS and test sources, then the
+# whole compiler on a generated class. Expects TokenizerBench and
+# JackAnalyzer_bench in 11, which make bench builds first. FUNCTIONS
+# sets the size of the generated class.
+
+set -e
+
+here=$(cd "$(dirname "$0")" && pwd)
+root=$(dirname "$here")
+repo=$(dirname "$root")
+functions=${FUNCTIONS:-150000}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+for copy in $(seq 20); do
+    cat "$repo"/12/*.jack "$root"/test/*/*.jack
+done > "$work/sources.jack"
+echo "sources: $(wc -c < "$work/sources.jack") bytes"
+"$root/TokenizerBench" "$work/sources.jack"
+
+mkdir "$work/big"
+"$here/generate_jack.sh" "$functions" > "$work/big/Big.jack"
+echo "generated class: $functions functions, $(wc -c < "$work/big/Big.jack") bytes"
+
+best=
+for run in 1 2 3; do
+    start=$(date +%s%N)
+    (cd "$work" && "$root/JackAnalyzer_bench" big/Big.jack > /dev/null)
+    ms=$(( ($(date +%s%N) - start) / 1000000 ))
+    if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+        best=$ms
+    fi
+done
+echo "compile: $best ms"